@@ -0,0 +1,135 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Allocation check of the generation loop.
+
+  The wrappers are linked with '-Wl,--wrap=malloc,--wrap=calloc,
+  --wrap=realloc' (see the Makefile), which makes the calls in the
+  FEMO objects go to __wrap_malloc() etc. The counter isn't locked,
+  the selector allocates from one thread only.
+
+  C file.
+
+  file: femo_alloc.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_alloc.h"
+
+#ifdef FEMO_ALLOC_CHECK
+
+/*--------------------| global variable definitions |-------------------*/
+
+/* only used in this file */
+
+static long allocations = 0; /* calls to malloc, calloc and realloc */
+
+static long allocations_before = 0; /* value at alloc_begin() */
+
+static int grown = 0; /* 1 after alloc_grown() in this generation */
+
+static int failures = 0; /* generations reported */
+
+/*-------------------------| wrapper functions |------------------------*/
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+
+void *__wrap_malloc(size_t size)
+{
+     allocations++;
+     return (__real_malloc(size));
+}
+
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+     allocations++;
+     return (__real_calloc(count, size));
+}
+
+
+void *__wrap_realloc(void *pointer, size_t size)
+{
+     allocations++;
+     return (__real_realloc(pointer, size));
+}
+
+/*-------------------------| check functions |--------------------------*/
+
+void alloc_begin(void)
+{
+     allocations_before = allocations;
+     grown = 0;
+}
+
+
+void alloc_grown(void)
+{
+     grown = 1;
+}
+
+
+int alloc_end(int generation)
+{
+     int count;
+     char message[80];
+
+     count = (int) (allocations - allocations_before);
+     if (count > 0 && generation > ALLOC_WARM_UP && !grown)
+     {
+          sprintf(message, "generation %d made %d heap allocations",
+                  generation, count);
+          log_to_file(log_file, __FILE__, __LINE__, message);
+          fprintf(stderr, "FEMO: %s\n", message);
+          failures++;
+     }
+     return (count);
+}
+
+
+int alloc_failures(void)
+{
+     return (failures);
+}
+
+#else /* counting needs the wrapped build */
+
+void alloc_begin(void)
+{
+}
+
+
+void alloc_grown(void)
+{
+}
+
+
+int alloc_end(int generation)
+{
+     return (0);
+}
+
+
+int alloc_failures(void)
+{
+     return (0);
+}
+
+#endif /* FEMO_ALLOC_CHECK */
@@ -0,0 +1,64 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Allocation check of the generation loop.
+
+  If FEMO is compiled with 'make ALLOC_CHECK=1', malloc(), calloc()
+  and realloc() calls of the FEMO code are counted (the linker
+  redirects them with --wrap, allocations inside the C library, e.g.
+  by fopen(), are not counted). Without it the functions do nothing.
+
+  The structures that grow with the archive are sized for
+  'work_capacity' individuals when a run starts (see
+  workspace_reserve()) and are keyed by the handle of an individual,
+  not by its identity. They grow, all at once, only when the archive
+  outgrows the capacity, which then at least doubles, so apart from
+  these generations (calling alloc_grown()) a generation after the
+  warm-up must not allocate at all. The asynchronous mode and the
+  sessions are not checked.
+
+  Header file.
+
+  file: femo_alloc.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_ALLOC_H
+#define FEMO_ALLOC_H
+
+/*-------------------------| constants |--------------------------------*/
+
+#define ALLOC_WARM_UP 3
+/* generations after which a generation must not allocate any more */
+
+/*-------------------------| functions |--------------------------------*/
+
+void alloc_begin(void);
+/* Remembers the number of allocations so far, called before a
+   generation. */
+
+void alloc_grown(void);
+/* Marks the current generation as one in which the capacity of the
+   run (or the array of identities) grew, it may allocate. */
+
+int alloc_end(int generation);
+/* Compares the number of allocations with the one of alloc_begin().
+   After the warm-up a generation that allocated without alloc_grown()
+   is reported in the log file and on stderr.
+   Returns the number of allocations of the generation (always 0
+   without ALLOC_CHECK). */
+
+int alloc_failures(void);
+/* Returns the number of generations reported so far (always 0
+   without ALLOC_CHECK). */
+
+#endif /* FEMO_ALLOC_H */
@@ -0,0 +1,264 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Worker slots of the asynchronous (steady-state) mode.
+
+  A result file is parsed completely before any individual is added,
+  so a file that is still being written is simply read again later.
+  The result file is reset before the parents are written, otherwise
+  the next result of a fast worker could be wiped out.
+
+  C file.
+
+  file: femo_async.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_async.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int async_slots = 0; /* number of worker slots, 0 if synchronous */
+
+/* only used in this file */
+
+#define SLOT_NAME_LENGTH (FILE_NAME_LENGTH_INTERNAL + 16)
+
+static char (*result_files)[SLOT_NAME_LENGTH] = NULL; /* '<base>var<k>' */
+
+static char (*parent_files)[SLOT_NAME_LENGTH] = NULL; /* '<base>sel<k>' */
+
+static int *read_ids = NULL; /* identities of the last results read */
+
+static double *read_values = NULL; /* their objective values */
+
+static int read_capacity = 0; /* individuals that fit into the buffers */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static int first_number(char *file)
+/* Returns the first number in 'file', 0 if the file doesn't exist and
+   -1 if it can't be read (e.g. while it is being written). */
+{
+     FILE *fp;
+     int number = -1;
+
+     fp = fopen(file, "r");
+     if (fp == NULL)
+          return (0);
+     if (fscanf(fp, "%d", &number) != 1)
+          number = -1;
+     fclose(fp);
+     return (number);
+}
+
+
+static int reserve(int count)
+/* Makes the read buffers large enough for 'count' individuals. */
+{
+     int *ids;
+     double *values;
+
+     if (count <= read_capacity)
+          return (0);
+     ids = (int *) realloc(read_ids, count * sizeof(int));
+     if (ids == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     read_ids = ids;
+     values = (double *) realloc(read_values,
+                                 (size_t) count * dimension * sizeof(double));
+     if (values == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     read_values = values;
+     read_capacity = count;
+     return (0);
+}
+
+/*-------------------------| async functions |--------------------------*/
+
+int async_init(int slots, int clear)
+/* Sets up the slot file names and optionally resets the files. */
+{
+     int k;
+
+     async_free();
+     result_files = malloc(slots * sizeof(*result_files));
+     parent_files = malloc(slots * sizeof(*parent_files));
+     if (result_files == NULL || parent_files == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          async_free();
+          return (1);
+     }
+
+     for (k = 0; k < slots; k++)
+     {
+          sprintf(result_files[k], "%s%d", var_file, k);
+          sprintf(parent_files[k], "%s%d", sel_file, k);
+          if (clear && (clear_file(result_files[k]) != 0
+                        || clear_file(parent_files[k]) != 0))
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "couldn't reset worker files");
+               async_free();
+               return (1);
+          }
+     }
+     async_slots = slots;
+     return (0);
+}
+
+
+int async_read(int slot, int **identities, int *count)
+/* Reads the results of one worker if they are complete. */
+{
+     FILE *fp;
+     int i, j, size, number;
+     char tag[4];
+
+     *identities = read_ids;
+     *count = 0;
+
+     /* the worker has to read its parents before it sends results */
+     if (first_number(parent_files[slot]) != 0)
+          return (0);
+
+     fp = fopen(result_files[slot], "r");
+     if (fp == NULL)
+          return (0);
+     if (fscanf(fp, "%d", &size) != 1 || size <= 0)
+     {
+          fclose(fp);
+          return (0); /* no results yet */
+     }
+     if (size % (dimension + 1) != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "size in worker file is wrong");
+          fclose(fp);
+          return (1);
+     }
+
+     number = size / (dimension + 1);
+     if (reserve(number) != 0)
+     {
+          fclose(fp);
+          return (1);
+     }
+     for (j = 0; j < number; j++)
+     {
+          if (fscanf(fp, "%d", &read_ids[j]) != 1)
+          {
+               fclose(fp);
+               return (0); /* not completely written */
+          }
+          for (i = 0; i < dimension; i++)
+          {
+               if (fscanf(fp, "%le", &read_values[j * dimension + i]) != 1)
+               {
+                    fclose(fp);
+                    return (0);
+               }
+          }
+     }
+     if (fscanf(fp, "%3s", tag) != 1 || strcmp(tag, "END") != 0)
+     {
+          fclose(fp);
+          return (0);
+     }
+     fclose(fp);
+
+     for (j = 0; j < number; j++)
+     {
+          read_ids[j] = get_identity(current_channel, read_ids[j]);
+          if (read_ids[j] == -1)
+               return (1);
+          if (get_individual(read_ids[j]) != NULL)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "identity in worker file is already used");
+               return (1);
+          }
+          if (add_individual(read_ids[j], &read_values[j * dimension]) != 0)
+               return (1);
+     }
+     *identities = read_ids;
+     *count = number;
+     return (0);
+}
+
+
+int async_write(int slot, int *identities, int count)
+/* Hands out new parents to one worker. */
+{
+     FILE *fp;
+     int i;
+
+     if (clear_file(result_files[slot]) != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't reset worker file");
+          return (1);
+     }
+
+     fp = fopen(parent_files[slot], "w");
+     if (fp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't write worker file");
+          return (1);
+     }
+     fprintf(fp, "%d\n", count);
+     for (i = 0; i < count; i++)
+          fprintf(fp, "%d\n", get_local_identity(identities[i]));
+     fprintf(fp, "END");
+     fclose(fp);
+     return (0);
+}
+
+
+int async_write_arc(void)
+/* Writes the 'arc' file unless the previous one is unread. */
+{
+     if (check_arc() != 0)
+          return (2);
+     return (write_arc() == 0 ? 0 : 1);
+}
+
+
+void async_free(void)
+/* Frees all memory. */
+{
+     free(result_files);
+     free(parent_files);
+     free(read_ids);
+     free(read_values);
+     result_files = NULL;
+     parent_files = NULL;
+     read_ids = NULL;
+     read_values = NULL;
+     read_capacity = 0;
+     async_slots = 0;
+}
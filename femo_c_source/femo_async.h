@@ -0,0 +1,63 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Worker slots of the asynchronous (steady-state) mode.
+
+  Instead of one 'var' file with lambda offspring per generation, every
+  worker k of the variator has a pair of files: it writes its results
+  to '<filenamebase>var<k>' and receives its next parents in
+  '<filenamebase>sel<k>'. Both use the format of the 'var' and 'sel'
+  files, and, as there, the reader resets a file to '0' when it has
+  read it.
+
+  Header file.
+
+  file: femo_async.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_ASYNC_H
+#define FEMO_ASYNC_H
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int async_slots; /* number of worker slots, 0 if synchronous */
+
+/*-------------------------| functions |--------------------------------*/
+
+int async_init(int slots, int clear);
+/* Sets up the file names for 'slots' workers. If 'clear' is 1, all
+   slot files are reset to '0' (start of a new run).
+   Returns 0 if successful and 1 otherwise. */
+
+int async_read(int slot, int **identities, int *count);
+/* Reads the results of worker 'slot' and adds them to the global
+   population. '*identities' is set to an internal array with their
+   identities and '*count' to their number, 0 if the worker has not
+   finished yet (or its last parents haven't been read). The results
+   are only added once the file has been written completely.
+   Returns 0 if successful and 1 if the file is invalid. */
+
+int async_write(int slot, int *identities, int count);
+/* Resets the result file of worker 'slot' and writes the 'count'
+   parents in 'identities' to its parent file.
+   Returns 0 if successful and 1 otherwise. */
+
+int async_write_arc(void);
+/* Writes the 'arc' file if the variator has read the previous one.
+   Returns 0 if it was written, 2 if the previous one is still unread
+   and 1 if writing failed. */
+
+void async_free(void);
+/* Frees all memory, the mode is switched off. */
+
+#endif /* FEMO_ASYNC_H */
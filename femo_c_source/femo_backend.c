@@ -0,0 +1,675 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Archive backends.
+
+  'linear' is the original FEMO archive. Since equal vectors are
+  rejected before insert_batch(), the archive is always the set of
+  nondominated vectors seen so far, whatever the order in which a
+  batch is processed, so 'sorted2d' inserts the new individuals one
+  by one and ends with the same members.
+
+  In a nondominated set of two objectives the second objective falls
+  strictly while the first one rises, so the predecessor of a vector
+  in the first objective is the only member that can dominate it, and
+  the members it dominates follow it directly. NaN breaks this order:
+  'sorted2d' hands the archive to 'linear' as soon as one appears.
+  'bitset' and 'mpi' do the same.
+
+  C file.
+
+  file: femo_backend.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_trace.h"
+#include "femo_tree.h"
+#include "femo_epsilon.h"
+#include "femo_query.h"
+#include "femo_bitset.h"
+#include "femo_duplicates.h"
+#include "femo_mpi.h"
+#include "femo_backend.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+char backend_name[BACKEND_NAME_LENGTH] = "auto"; /* 'archive_backend'
+                                                    parameter */
+
+int expected_archive = 0; /* expected archive size, 0 if unknown */
+
+/* only used in this file */
+
+static tree sorted_members; /* sorted2d: members by first objective */
+
+static int sorted_ready = 0; /* 1 after tree_init() */
+
+/*-------------------------| linear backend |---------------------------*/
+
+static int linear_insert_batch(int size, int *new_identity)
+/* The two passes of the original FEMO. */
+{
+     int i;
+     int dominated = 0;
+     int current_identity;
+     int result;
+     double span_begin;
+
+     /* delete all by new_identity dominated individuals */
+     span_begin = trace_begin();
+     for(i = 0; i < size; i++)
+     {
+          /* only if new_identity[i] not removed yet */
+          if(get_individual(new_identity[i]) != NULL)
+          {
+               /* deleting all individuals which are
+                  dominated by new_identity[i]*/
+               current_identity = get_first();
+               while(current_identity != -1)
+               {
+                    /* skip, if trying to compare to self */
+                    if(current_identity == new_identity[i])
+                         current_identity = get_next(current_identity);
+                    if(current_identity == -1)
+                         break;
+                    /* domination testing */
+                    if(dominates(new_identity[i], current_identity,
+                                 dimension))
+                    {
+                         result = femo_remove(current_identity);
+                         if(result != 0)
+                         {
+                              log_to_file(log_file, __FILE__, __LINE__, 
+                                          "removing individual failed");
+                              return (1);
+                         }
+                    } 
+                    current_identity = get_next(current_identity);
+               }
+          }
+     }
+
+     trace_end("remove_dominated", "select", span_begin);
+
+     /* check if new are dominated */ 
+     span_begin = trace_begin();
+     for(i = size-1; i >= 0 ; i--)
+     {
+          dominated = 0;
+
+          /* only if new_identity[i] not removed yet */
+          if (get_individual(new_identity[i]) != NULL)
+          {
+               current_identity = get_first();
+               while (current_identity != -1 && !dominated)
+               {
+                    /* skip, if trying to compare to self */
+                    if(current_identity == new_identity[i])
+                         current_identity = get_next(current_identity);
+                    if(current_identity == -1)
+                         break;    
+
+                    if (dominates(current_identity, new_identity[i],
+                                  dimension))
+                         dominated = 1;
+
+                    current_identity = get_next(current_identity);
+               }
+
+               if (dominated) /* remove new from global population */
+               {
+                    result=femo_remove(new_identity[i]);
+                    if (result != 0)
+                    {
+
+                         log_to_file(log_file, __FILE__, __LINE__,
+                                     "removing individual failed");
+                         return (1);
+                    }
+
+               }
+          }
+     }
+     trace_end("reject_new", "select", span_begin);
+     return (0);
+}
+
+
+static int linear_adopt(int identity)
+{
+     return (0);
+}
+
+
+static int linear_query(double *objective_value, int *removed)
+/* Compares the vector with all members. */
+{
+     int i, id;
+     int a_is_worse, b_is_worse, differs;
+     int result = QUERY_ACCEPTED;
+     objective_t *member;
+
+     *removed = 0;
+     for (id = get_first(); id != -1; id = get_next(id))
+     {
+          member = get_individual(id)->objective_value;
+          a_is_worse = 0;
+          b_is_worse = 0;
+          differs = 0;
+          for (i = 0; i < dimension; i++)
+          {
+               a_is_worse |= objective_value[i] > member[i];
+               b_is_worse |= member[i] > objective_value[i];
+               differs |= objective_value[i] != member[i];
+          }
+          if (!differs)
+          {
+               *removed = 0;
+               return (QUERY_EQUAL);
+          }
+          if (result == QUERY_DOMINATED)
+               continue; /* only an equal member can change the result */
+          /* as in update_archive(), the members the vector dominates
+             are removed before it is checked against the others */
+          if (!a_is_worse)
+               (*removed)++;
+          else if (!b_is_worse)
+               result = QUERY_DOMINATED;
+     }
+
+     if (result != QUERY_ACCEPTED)
+          *removed = 0;
+     return (result);
+}
+
+
+static int linear_remove(int identity)
+{
+     return (0);
+}
+
+
+static int linear_snapshot(int *identities)
+{
+     int id, count = 0;
+
+     for (id = backend->first(); id != -1; id = backend->next(id))
+          identities[count++] = id;
+     return (count);
+}
+
+
+static int linear_reserve(int count)
+{
+     return (0);
+}
+
+
+static void linear_clear(void)
+{
+}
+
+
+static archive_backend linear_backend =
+{
+     "linear", linear_insert_batch, linear_adopt, linear_query,
+     linear_remove, get_first, get_next, femo_choose, linear_snapshot,
+     linear_reserve, linear_clear, linear_clear
+};
+
+archive_backend *backend = &linear_backend; /* backend in use */
+
+/*-------------------------| epsilon backend |--------------------------*/
+
+static int epsilon_insert_batch(int size, int *new_identity)
+/* The new individuals compete for their boxes one after the other. */
+{
+     int i;
+     double span_begin;
+
+     span_begin = trace_begin();
+     for(i = 0; i < size; i++)
+     {
+          if(get_individual(new_identity[i]) != NULL
+             && epsilon_update(new_identity[i]) != 0)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "epsilon archive update failed");
+               return (1);
+          }
+     }
+     trace_end("epsilon_update", "select", span_begin);
+     return (0);
+}
+
+
+static int epsilon_backend_query(double *objective_value, int *removed)
+/* An equal member decides first, as in update_archive(). */
+{
+     int i, id, differs;
+     objective_t *member;
+
+     *removed = 0;
+     for (id = get_first(); id != -1; id = get_next(id))
+     {
+          member = get_individual(id)->objective_value;
+          differs = 0;
+          for (i = 0; i < dimension; i++)
+               differs |= objective_value[i] != member[i];
+          if (!differs)
+               return (QUERY_EQUAL);
+     }
+     return (epsilon_query(objective_value, removed));
+}
+
+
+static archive_backend epsilon_backend =
+{
+     "epsilon", epsilon_insert_batch, epsilon_update, epsilon_backend_query,
+     epsilon_remove, get_first, get_next, femo_choose, linear_snapshot,
+     epsilon_reserve, linear_clear, linear_clear
+};
+
+/*-------------------------| sorted2d backend |-------------------------*/
+
+static double first_value(int identity)
+{
+     return (get_individual(identity)->objective_value[0]);
+}
+
+
+static double second_value(int identity)
+{
+     return (get_individual(identity)->objective_value[1]);
+}
+
+
+static int has_nan(double a, double b)
+{
+     return (a != a || b != b);
+}
+
+
+static int sorted_reserve(int count)
+{
+     return (sorted_ready ? tree_reserve(&sorted_members, count) : 0);
+}
+
+
+static void sorted_clear(void)
+{
+     if (sorted_ready)
+          tree_clear(&sorted_members);
+}
+
+
+static void sorted_release(void)
+{
+     if (sorted_ready)
+          tree_free(&sorted_members);
+     sorted_ready = 0;
+}
+
+
+static int sorted_insert_batch(int size, int *new_identity)
+/* Inserts the new individuals one by one. */
+{
+     int i, id, node, member;
+     double f1, f2;
+     double span_begin;
+
+     for (i = 0; i < size; i++)
+     {
+          id = new_identity[i];
+          if (get_individual(id) != NULL
+              && has_nan(first_value(id), second_value(id)))
+          {
+               /* the order is lost, linear takes over for good */
+               sorted_release();
+               backend = &linear_backend;
+               return (linear_insert_batch(size, new_identity));
+          }
+     }
+
+     span_begin = trace_begin();
+     for (i = 0; i < size; i++)
+     {
+          id = new_identity[i];
+          if (get_individual(id) == NULL)
+               continue; /* equal to another one */
+          f1 = first_value(id);
+          f2 = second_value(id);
+
+          /* the member with the largest first value not above f1 */
+          node = tree_lower(&sorted_members, f1, INT_MAX);
+          if (node != -1
+              && second_value(TREE_IDENTITY(&sorted_members, node)) <= f2)
+          {
+               if (femo_remove(id) != 0)
+                    return (1);
+               continue;
+          }
+
+          /* the dominated members follow from f1 on */
+          node = tree_higher(&sorted_members, f1, -1);
+          while (node != -1)
+          {
+               member = TREE_IDENTITY(&sorted_members, node);
+               if (second_value(member) < f2)
+                    break;
+               if (femo_remove(member) != 0)
+                    return (1);
+               node = tree_higher(&sorted_members, f1, -1);
+          }
+          if (tree_insert(&sorted_members, f1, id) != 0)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "selector out of memory");
+               return (1);
+          }
+     }
+     trace_end("sorted_insert", "select", span_begin);
+     return (0);
+}
+
+
+static int sorted_adopt(int identity)
+{
+     double f1, f2;
+
+     f1 = first_value(identity);
+     f2 = second_value(identity);
+     if (has_nan(f1, f2))
+     {
+          sorted_release();
+          backend = &linear_backend;
+          return (0);
+     }
+     return (tree_insert(&sorted_members, f1, identity));
+}
+
+
+static int sorted_query(double *objective_value, int *removed)
+/* Looks at the predecessor and the members following it. */
+{
+     int node, member;
+     double f1, f2;
+
+     f1 = objective_value[0];
+     f2 = objective_value[1];
+     if (has_nan(f1, f2))
+          return (linear_query(objective_value, removed));
+
+     *removed = 0;
+     node = tree_lower(&sorted_members, f1, INT_MAX);
+     if (node != -1)
+     {
+          member = TREE_IDENTITY(&sorted_members, node);
+          if (first_value(member) == f1 && second_value(member) == f2)
+               return (QUERY_EQUAL);
+          if (second_value(member) <= f2)
+               return (QUERY_DOMINATED);
+     }
+     node = tree_higher(&sorted_members, f1, -1);
+     while (node != -1)
+     {
+          member = TREE_IDENTITY(&sorted_members, node);
+          if (second_value(member) < f2)
+               break;
+          (*removed)++;
+          node = tree_higher(&sorted_members, first_value(member), member);
+     }
+     return (QUERY_ACCEPTED);
+}
+
+
+static int sorted_remove(int identity)
+{
+     if (sorted_ready)
+          tree_remove(&sorted_members, first_value(identity), identity);
+     return (0); /* not a member yet */
+}
+
+
+static archive_backend sorted2d_backend =
+{
+     "sorted2d", sorted_insert_batch, sorted_adopt, sorted_query,
+     sorted_remove, get_first, get_next, femo_choose, linear_snapshot,
+     sorted_reserve, sorted_clear, sorted_release
+};
+
+/*-------------------------| bitset backend |---------------------------*/
+
+static int vector_has_nan(double *objective_value)
+{
+     int k;
+
+     for (k = 0; k < dimension; k++)
+          if (objective_value[k] != objective_value[k])
+               return (1);
+     return (0);
+}
+
+
+static int member_has_nan(int identity)
+/* The stored values may be floats, see objective_t. */
+{
+     int k;
+     double value;
+
+     for (k = 0; k < dimension; k++)
+     {
+          value = get_objective_value(identity, k);
+          if (value != value)
+               return (1);
+     }
+     return (0);
+}
+
+
+static int bitset_insert_batch(int size, int *new_identity)
+/* Tests the new individuals one by one against the bitsets. */
+{
+     int i, id;
+     double span_begin;
+
+     for (i = 0; i < size; i++)
+     {
+          id = new_identity[i];
+          if (get_individual(id) != NULL
+              && member_has_nan(id))
+          {
+               /* the order is lost, linear takes over for good */
+               bitset_free();
+               backend = &linear_backend;
+               return (linear_insert_batch(size, new_identity));
+          }
+     }
+
+     span_begin = trace_begin();
+     for (i = 0; i < size; i++)
+     {
+          id = new_identity[i];
+          if (get_individual(id) == NULL)
+               continue; /* equal to another one */
+          if (bitset_update(id) != 0)
+               return (1);
+     }
+     trace_end("bitset_insert", "select", span_begin);
+     return (0);
+}
+
+
+static int bitset_backend_adopt(int identity)
+{
+     if (member_has_nan(identity))
+     {
+          bitset_free();
+          backend = &linear_backend;
+          return (0);
+     }
+     return (bitset_adopt(identity));
+}
+
+
+static int bitset_backend_query(double *objective_value, int *removed)
+{
+     if (vector_has_nan(objective_value))
+          return (linear_query(objective_value, removed));
+     return (bitset_query(objective_value, removed));
+}
+
+
+static archive_backend bitset_backend =
+{
+     "bitset", bitset_insert_batch, bitset_backend_adopt,
+     bitset_backend_query, bitset_remove, get_first, get_next, femo_choose,
+     linear_snapshot, bitset_reserve, bitset_clear, bitset_free
+};
+
+/*-------------------------| mpi backend |------------------------------*/
+
+static int mpi_hand_back(int size, int *new_identity)
+/* The ranks give the objective values of the members back to rank 0
+   and 'linear' takes over for good. The new individuals haven't been
+   checked for equal vectors yet, that is done here as in
+   update_archive(). */
+{
+     int i, equal;
+
+     if (mpi_collect() != 0)
+          return (1);
+     backend = &linear_backend;
+     for (i = 0; i < size; i++)
+     {
+          if (get_individual(new_identity[i]) == NULL)
+               continue;
+          if (duplicate_insert(new_identity[i], &equal) != 0)
+               return (1);
+          if (equal != -1 && femo_remove(new_identity[i]) != 0)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "removing individual failed");
+               return (1);
+          }
+     }
+     return (0);
+}
+
+
+static int mpi_backend_insert_batch(int size, int *new_identity)
+{
+     int i, id;
+
+     for (i = 0; i < size; i++)
+     {
+          id = new_identity[i];
+          if (get_individual(id) != NULL
+              && member_has_nan(id))
+          {
+               if (mpi_hand_back(size, new_identity) != 0)
+                    return (1);
+               return (linear_insert_batch(size, new_identity));
+          }
+     }
+     return (mpi_insert_batch(size, new_identity));
+}
+
+
+static int mpi_backend_adopt(int identity)
+{
+     if (member_has_nan(identity))
+          return (mpi_hand_back(1, &identity));
+     return (mpi_adopt(identity));
+}
+
+
+static archive_backend mpi_backend =
+{
+     "mpi", mpi_backend_insert_batch, mpi_backend_adopt, mpi_query,
+     mpi_remove, get_first, get_next, mpi_choose, linear_snapshot,
+     linear_reserve, mpi_clear, mpi_release
+};
+
+/*-------------------------| selection |--------------------------------*/
+
+int backend_select(int expected)
+{
+     backend_free();
+     if (strcmp(backend_name, "auto") == 0)
+     {
+          if (epsilon_enabled)
+               backend = &epsilon_backend;
+          else if (mpi_ranks > 1)
+               backend = &mpi_backend;
+          else if (dimension == 2
+                   && (expected == 0 || expected >= BACKEND_SORTED_MIN))
+               backend = &sorted2d_backend;
+          else if (dimension >= BACKEND_BITSET_DIM
+                   && (expected == 0 || expected >= BACKEND_SORTED_MIN))
+               backend = &bitset_backend;
+          else
+               backend = &linear_backend;
+     }
+     else if (strcmp(backend_name, "linear") == 0)
+          backend = &linear_backend;
+     else if (strcmp(backend_name, "sorted2d") == 0)
+          backend = &sorted2d_backend;
+     else if (strcmp(backend_name, "epsilon") == 0)
+          backend = &epsilon_backend;
+     else if (strcmp(backend_name, "bitset") == 0)
+          backend = &bitset_backend;
+     else if (strcmp(backend_name, "mpi") == 0)
+          backend = &mpi_backend;
+     else
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "unknown archive_backend");
+          return (1);
+     }
+
+     if ((backend == &epsilon_backend) != (epsilon_enabled != 0)
+         || (backend == &sorted2d_backend && dimension != 2))
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "archive_backend doesn't fit the parameters");
+          backend = &linear_backend;
+          return (1);
+     }
+     if (backend == &sorted2d_backend)
+     {
+          tree_init(&sorted_members);
+          sorted_ready = 1;
+     }
+     if ((backend == &bitset_backend && bitset_init() != 0)
+         || (backend == &mpi_backend && mpi_init() != 0))
+     {
+          backend = &linear_backend;
+          return (1);
+     }
+     return (0);
+}
+
+
+void backend_free(void)
+{
+     backend->release();
+     backend = &linear_backend;
+}
@@ -0,0 +1,126 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Archive backends.
+
+  The dominance logic of the archive is reached through the functions
+  of the backend in use, so an index for the archive members can be
+  added without touching select_ind() or the state machine. The
+  individuals themselves always stay in the global population, the
+  bookkeeping of duplicates, hypervolume and truncation is done by
+  update_archive() and femo_remove() for all backends.
+
+  Backends:
+
+    linear    scans all members, for any number of objectives
+    sorted2d  members in a tree sorted by the first objective, for
+              two objectives; a query or an insertion takes O(log n)
+              plus the members removed
+    epsilon   the epsilon archive (femo_epsilon.h)
+    bitset    per objective a tree and prefix bitsets of the ranks
+              (femo_bitset.h), for many objectives; a query or an
+              insertion takes O(dim * n / 64) word operations
+    mpi       the archive partitioned across MPI ranks (femo_mpi.h)
+
+  Members are iterated in the order of their identities by all
+  backends, so the mating selection doesn't depend on the backend.
+
+  Header file.
+
+  file: femo_backend.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_BACKEND_H
+#define FEMO_BACKEND_H
+
+/*-------------------------| constants |--------------------------------*/
+
+#define BACKEND_NAME_LENGTH 32
+
+#define BACKEND_SORTED_MIN 64
+/* expected archive size from which 'auto' uses an index */
+
+#define BACKEND_BITSET_DIM 6
+/* number of objectives from which 'auto' uses 'bitset' */
+
+/*-------------------------| backend |----------------------------------*/
+
+typedef struct archive_backend_t
+{
+     char *name;
+
+     int (*insert_batch)(int size, int *new_identity);
+     /* The 'size' new individuals (already in the global population,
+        equal ones removed) enter the archive: members dominated by one
+        of them and new ones dominated by a member are removed with
+        femo_remove(). Returns 0 if successful and 1 otherwise. */
+
+     int (*adopt)(int identity);
+     /* Takes over the existing member 'identity' without any test
+        (restored archive). Returns 0 if successful and 1 otherwise. */
+
+     int (*query)(double *objective_value, int *removed);
+     /* Tells what insert_batch() would do with a vector (rounded like
+        stored values), see femo_query(). */
+
+     int (*remove)(int identity);
+     /* Called by femo_remove() while the individual still exists.
+        Does nothing for non-members. Returns 0 if successful and 1
+        otherwise. */
+
+     int (*first)(void);
+     int (*next)(int identity);
+     /* Iterate the members, -1 after the last one. */
+
+     int (*choose)(void);
+     /* Returns a member of the current variator with the lowest
+        counter (chosen at random among those), -1 if there is none. */
+
+     int (*snapshot)(int *identities);
+     /* Copies the identities of all members (room for get_size())
+        in the order of first()/next(). Returns their number. */
+
+     int (*reserve)(int count);
+     /* Makes room for 'count' members with handles below 'count' (see
+        workspace_reserve()), so that the backend allocates nothing
+        below it. Returns 0 if successful and 1 otherwise. */
+
+     void (*clear)(void);
+     /* Forgets all members, memory is kept. */
+
+     void (*release)(void);
+     /* Frees all memory of the backend. */
+} archive_backend;
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern archive_backend *backend; /* backend in use */
+
+extern char backend_name[]; /* 'archive_backend' parameter, "auto" if
+                               not given */
+
+extern int expected_archive; /* expected archive size, 0 if unknown */
+
+/*-------------------------| functions |--------------------------------*/
+
+int backend_select(int expected);
+/* Chooses the backend from 'backend_name', or with 'auto' from the
+   epsilon parameters, 'dimension' and the 'expected' archive size
+   (0 if unknown). The archive must be empty.
+   Returns 0 if successful and 1 if the backend is unknown or doesn't
+   fit the parameters. */
+
+void backend_free(void);
+/* Frees the memory of the backend in use. */
+
+#endif /* FEMO_BACKEND_H */
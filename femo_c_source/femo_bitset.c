@@ -0,0 +1,586 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Bitset dominance engine for archives with many objectives.
+
+  Prefix bitset b of objective k holds the slots of the members with
+  a rank below b * bucket in that objective. Boundaries beyond the
+  number of members hold all members. All bitsets have room for all
+  slots; when the slots run out their number is doubled and the
+  prefix bitsets are rebuilt from the trees.
+
+  C file.
+
+  file: femo_bitset.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_tree.h"
+#include "femo_query.h"
+#include "femo_bitset.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+/* only used in this file */
+
+typedef unsigned long long bitword;
+
+#define WORD_BITS 64
+
+static tree *ranks = NULL; /* one per objective */
+
+static int rank_dimension = 0; /* trees allocated */
+
+static int capacity = 0; /* slots */
+
+static int words = 0; /* words per bitset */
+
+static int bucket = BITSET_MIN_BUCKET; /* ranks per bucket */
+
+static int boundaries = 0; /* prefix bitsets per objective */
+
+static bitword *prefix = NULL; /* dimension * boundaries bitsets */
+
+static bitword *members = NULL; /* occupied slots */
+
+static bitword *covering = NULL; /* members weakly dominating a vector */
+
+static bitword *covered = NULL; /* members weakly dominated by it */
+
+static bitword *part = NULL; /* members below a rank */
+
+static int *slot_identity = NULL; /* member in each slot */
+
+static int *free_slots = NULL; /* slots given back */
+
+static int free_count = 0;
+
+static int slots_used = 0; /* slots handed out so far */
+
+static int *slot_of = NULL; /* slot of each handle, -1 if none */
+
+static int slot_of_size = 0;
+
+static int *doomed = NULL; /* members dominated by a new individual */
+
+static int doomed_size = 0;
+
+static double *vector = NULL; /* objective values of a new individual */
+
+#define PREFIX(k, b) (prefix + ((size_t) (k) * boundaries + (b)) * words)
+
+/*-------------------------| helper functions |-------------------------*/
+
+static void bit_set(bitword *bits, int slot)
+{
+     bits[slot / WORD_BITS] |= (bitword) 1 << (slot % WORD_BITS);
+}
+
+
+static void bit_clear(bitword *bits, int slot)
+{
+     bits[slot / WORD_BITS] &= ~((bitword) 1 << (slot % WORD_BITS));
+}
+
+
+static int count_bits(bitword x)
+{
+#ifdef __GNUC__
+     return (__builtin_popcountll(x));
+#else
+     int count = 0;
+
+     while (x != 0)
+     {
+          x &= x - 1;
+          count++;
+     }
+     return (count);
+#endif
+}
+
+
+static int lowest_bit(bitword x)
+/* Returns the position of the lowest bit set in x (not 0). */
+{
+#ifdef __GNUC__
+     return (__builtin_ctzll(x));
+#else
+     int position = 0;
+
+     while ((x & 1) == 0)
+     {
+          x >>= 1;
+          position++;
+     }
+     return (position);
+#endif
+}
+
+
+static double value_of(int identity, int objective)
+{
+     return (get_individual(identity)->objective_value[objective]);
+}
+
+
+static int find_slot(int identity)
+{
+     int handle;
+
+     handle = get_handle(identity);
+     return (handle >= 0 && handle < slot_of_size ? slot_of[handle] : -1);
+}
+
+
+static int member_slot(int identity)
+/* find_slot() for a member */
+{
+     return (slot_of[get_individual(identity)->handle]);
+}
+
+
+static void below_rank(int k, int rank, bitword *bits)
+/* Stores the members with a rank below 'rank' in objective k. */
+{
+     int i, node, id;
+     tree *t = &ranks[k];
+
+     i = rank / bucket * bucket;
+     memcpy(bits, PREFIX(k, rank / bucket), words * sizeof(bitword));
+     node = i < rank ? tree_select(t, i) : -1;
+     for (; i < rank; i++)
+     {
+          id = TREE_IDENTITY(t, node);
+          bit_set(bits, member_slot(id));
+          node = tree_higher(t, TREE_KEY(t, node), id);
+     }
+}
+
+
+static int find_covering(double *values)
+/* Stores the members weakly dominating 'values' in 'covering'.
+   Returns 0 if there is none (the bitset may be incomplete then). */
+{
+     int i, k, any;
+
+     memcpy(covering, members, words * sizeof(bitword));
+     for (k = 0; k < dimension; k++)
+     {
+          /* not above: below the first pair after (value, any id) */
+          below_rank(k, tree_rank(&ranks[k], values[k], INT_MAX), part);
+          any = 0;
+          for (i = 0; i < words; i++)
+          {
+               covering[i] &= part[i];
+               any |= covering[i] != 0;
+          }
+          if (!any)
+               return (0);
+     }
+     return (1);
+}
+
+
+static int find_covered(double *values)
+/* Stores the members weakly dominated by 'values' in 'covered'.
+   Returns 0 if there is none (the bitset may be incomplete then). */
+{
+     int i, k, any;
+
+     memcpy(covered, members, words * sizeof(bitword));
+     for (k = 0; k < dimension; k++)
+     {
+          below_rank(k, tree_rank(&ranks[k], values[k], -1), part);
+          any = 0;
+          for (i = 0; i < words; i++)
+          {
+               covered[i] &= ~part[i];
+               any |= covered[i] != 0;
+          }
+          if (!any)
+               return (0);
+     }
+     return (1);
+}
+
+
+static void rebuild_prefixes(void)
+/* Computes all prefix bitsets from the trees. */
+{
+     int k, b, i, node, id;
+     tree *t;
+
+     for (k = 0; k < dimension; k++)
+     {
+          t = &ranks[k];
+          memset(part, 0, words * sizeof(bitword));
+          node = tree_first(t);
+          i = 0;
+          for (b = 0; b < boundaries; b++)
+          {
+               for (; i < b * bucket && node != -1; i++)
+               {
+                    id = TREE_IDENTITY(t, node);
+                    bit_set(part, member_slot(id));
+                    node = tree_higher(t, TREE_KEY(t, node), id);
+               }
+               memcpy(PREFIX(k, b), part, words * sizeof(bitword));
+          }
+     }
+}
+
+
+static int grow_slots(int new_capacity)
+/* Enlarges the slots to 'new_capacity' (a multiple of WORD_BITS).
+   Returns 0 if successful and 1 if out of memory. */
+{
+     int new_words, new_bucket, new_boundaries;
+     int *tmp_identity, *tmp_free;
+     bitword *tmp[5];
+     int i;
+
+     new_words = new_capacity / WORD_BITS;
+     new_bucket = new_capacity / BITSET_BUCKETS;
+     if (new_bucket < BITSET_MIN_BUCKET)
+          new_bucket = BITSET_MIN_BUCKET;
+     new_boundaries = new_capacity / new_bucket + 1;
+
+     tmp_identity = (int *) realloc(slot_identity, new_capacity * sizeof(int));
+     if (tmp_identity != NULL)
+          slot_identity = tmp_identity;
+     tmp_free = (int *) realloc(free_slots, new_capacity * sizeof(int));
+     if (tmp_free != NULL)
+          free_slots = tmp_free;
+     tmp[0] = (bitword *) realloc(members, new_words * sizeof(bitword));
+     if (tmp[0] != NULL)
+          members = tmp[0];
+     tmp[1] = (bitword *) realloc(covering, new_words * sizeof(bitword));
+     if (tmp[1] != NULL)
+          covering = tmp[1];
+     tmp[2] = (bitword *) realloc(covered, new_words * sizeof(bitword));
+     if (tmp[2] != NULL)
+          covered = tmp[2];
+     tmp[3] = (bitword *) realloc(part, new_words * sizeof(bitword));
+     if (tmp[3] != NULL)
+          part = tmp[3];
+     tmp[4] = (bitword *) realloc(prefix, (size_t) dimension * new_boundaries
+                                  * new_words * sizeof(bitword));
+     if (tmp[4] != NULL)
+          prefix = tmp[4];
+     if (tmp_identity == NULL || tmp_free == NULL || tmp[0] == NULL
+         || tmp[1] == NULL || tmp[2] == NULL || tmp[3] == NULL
+         || tmp[4] == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+
+     for (i = words; i < new_words; i++)
+          members[i] = 0;
+     capacity = new_capacity;
+     words = new_words;
+     bucket = new_bucket;
+     boundaries = new_boundaries;
+     rebuild_prefixes();
+     return (0);
+}
+
+
+static int grow_handles(int count)
+/* Makes 'slot_of' hold 'count' handles. Returns 0 if successful and 1
+   if out of memory. */
+{
+     int i, old_size;
+
+     old_size = slot_of_size;
+     if (grow_ints(&slot_of, &slot_of_size, count) != 0)
+          return (1);
+     for (i = old_size; i < slot_of_size; i++)
+          slot_of[i] = -1;
+     return (0);
+}
+
+
+static int map_identity(int identity, int slot)
+/* Records the slot of 'identity'. Returns 0 if successful and 1 if
+   out of memory. */
+{
+     int handle;
+
+     handle = get_handle(identity);
+     if (handle >= slot_of_size && grow_handles(handle + 1) != 0)
+          return (1);
+     slot_of[handle] = slot;
+     return (0);
+}
+
+/*-------------------------| bitset functions |-------------------------*/
+
+int bitset_init(void)
+{
+     int k;
+
+     bitset_free();
+     ranks = (tree *) malloc(dimension * sizeof(tree));
+     vector = (double *) malloc(dimension * sizeof(double));
+     if (ranks == NULL || vector == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          free(ranks);
+          free(vector);
+          ranks = NULL;
+          vector = NULL;
+          return (1);
+     }
+     for (k = 0; k < dimension; k++)
+          tree_init(&ranks[k]);
+     rank_dimension = dimension;
+     return (0);
+}
+
+
+void bitset_clear(void)
+{
+     int k;
+
+     for (k = 0; k < rank_dimension; k++)
+          tree_clear(&ranks[k]);
+     for (k = 0; k < slot_of_size; k++)
+          slot_of[k] = -1;
+     if (capacity > 0)
+     {
+          memset(members, 0, words * sizeof(bitword));
+          memset(prefix, 0, (size_t) rank_dimension * boundaries * words
+                 * sizeof(bitword));
+     }
+     free_count = 0;
+     slots_used = 0;
+}
+
+
+void bitset_free(void)
+{
+     int k;
+
+     for (k = 0; k < rank_dimension; k++)
+          tree_free(&ranks[k]);
+     free(ranks);
+     free(vector);
+     free(prefix);
+     free(members);
+     free(covering);
+     free(covered);
+     free(part);
+     free(slot_identity);
+     free(free_slots);
+     free(slot_of);
+     free(doomed);
+     ranks = NULL;
+     vector = NULL;
+     prefix = NULL;
+     members = NULL;
+     covering = NULL;
+     covered = NULL;
+     part = NULL;
+     slot_identity = NULL;
+     free_slots = NULL;
+     slot_of = NULL;
+     doomed = NULL;
+     rank_dimension = 0;
+     capacity = 0;
+     words = 0;
+     bucket = BITSET_MIN_BUCKET;
+     boundaries = 0;
+     free_count = 0;
+     slots_used = 0;
+     slot_of_size = 0;
+     doomed_size = 0;
+}
+
+
+int bitset_reserve(int count)
+/* Grows the slots by doubling, like bitset_adopt() would. */
+{
+     int k, new_capacity;
+
+     new_capacity = capacity == 0 ? 4 * WORD_BITS : capacity;
+     while (new_capacity < count)
+          new_capacity *= 2;
+     if ((new_capacity > capacity && grow_slots(new_capacity) != 0)
+         || (count > slot_of_size && grow_handles(count) != 0)
+         || grow_ints(&doomed, &doomed_size, count) != 0)
+          return (1);
+     for (k = 0; k < rank_dimension; k++)
+     {
+          if (tree_reserve(&ranks[k], count) != 0)
+               return (1);
+     }
+     return (0);
+}
+
+
+int bitset_adopt(int identity)
+/* Takes a slot and moves the member into the prefix bitsets above its
+   rank. */
+{
+     int k, b, slot, rank, node;
+     double value;
+     tree *t;
+
+     if (free_count == 0 && slots_used == capacity
+         && grow_slots(capacity == 0 ? 4 * WORD_BITS : 2 * capacity) != 0)
+          return (1);
+     slot = free_count > 0 ? free_slots[--free_count] : slots_used++;
+     if (map_identity(identity, slot) != 0)
+          return (1);
+     slot_identity[slot] = identity;
+     bit_set(members, slot);
+
+     for (k = 0; k < dimension; k++)
+     {
+          t = &ranks[k];
+          value = value_of(identity, k);
+          rank = tree_rank(t, value, identity);
+          if (tree_insert(t, value, identity) != 0)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "selector out of memory");
+               return (1);
+          }
+          /* the member at rank b * bucket is pushed out of prefix b */
+          node = 0;
+          for (b = rank / bucket + 1; b < boundaries; b++)
+          {
+               bit_set(PREFIX(k, b), slot);
+               if (node != -1)
+                    node = tree_select(t, b * bucket);
+               if (node != -1)
+                    bit_clear(PREFIX(k, b), member_slot(TREE_IDENTITY(t, node)));
+          }
+     }
+     return (0);
+}
+
+
+int bitset_remove(int identity)
+/* Gives the slot back, the member at rank b * bucket moves into
+   prefix b. */
+{
+     int k, b, slot, rank, node;
+     double value;
+     tree *t;
+
+     slot = find_slot(identity);
+     if (slot == -1)
+          return (0);
+     for (k = 0; k < dimension; k++)
+     {
+          t = &ranks[k];
+          value = value_of(identity, k);
+          rank = tree_rank(t, value, identity);
+          node = 0;
+          for (b = rank / bucket + 1; b < boundaries; b++)
+          {
+               bit_clear(PREFIX(k, b), slot);
+               if (node != -1)
+                    node = tree_select(t, b * bucket);
+               if (node != -1)
+                    bit_set(PREFIX(k, b), member_slot(TREE_IDENTITY(t, node)));
+          }
+          tree_remove(t, value, identity);
+     }
+     bit_clear(members, slot);
+     slot_of[get_handle(identity)] = -1;
+     free_slots[free_count++] = slot;
+     return (0);
+}
+
+
+int bitset_update(int identity)
+{
+     int i, k, count;
+     bitword x;
+
+     for (k = 0; k < dimension; k++)
+          vector[k] = value_of(identity, k);
+
+     if (capacity > 0 && find_covering(vector))
+     {
+          /* a member dominates it (equal vectors are gone already) */
+          if (femo_remove(identity) != 0)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "removing individual failed");
+               return (1);
+          }
+          return (0);
+     }
+
+     if (capacity > 0 && find_covered(vector))
+     {
+          /* collected first, femo_remove() changes the bitsets */
+          count = 0;
+          for (i = 0; i < words; i++)
+               count += count_bits(covered[i]);
+          if (grow_ints(&doomed, &doomed_size, count) != 0)
+               return (1);
+          count = 0;
+          for (i = 0; i < words; i++)
+          {
+               for (x = covered[i]; x != 0; x &= x - 1)
+                    doomed[count++] = slot_identity[i * WORD_BITS
+                                                    + lowest_bit(x)];
+          }
+          for (i = 0; i < count; i++)
+          {
+               if (femo_remove(doomed[i]) != 0)
+               {
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "removing individual failed");
+                    return (1);
+               }
+          }
+     }
+     return (bitset_adopt(identity));
+}
+
+
+int bitset_query(double *objective_value, int *removed)
+/* An equal member is in both sets. */
+{
+     int i, dominated;
+
+     *removed = 0;
+     if (capacity == 0)
+          return (QUERY_ACCEPTED);
+     dominated = find_covering(objective_value);
+     if (!find_covered(objective_value))
+          return (dominated ? QUERY_DOMINATED : QUERY_ACCEPTED);
+     for (i = 0; i < words && dominated; i++)
+     {
+          if ((covering[i] & covered[i]) != 0)
+               return (QUERY_EQUAL);
+     }
+     if (dominated)
+          return (QUERY_DOMINATED);
+     for (i = 0; i < words; i++)
+          *removed += count_bits(covered[i]);
+     return (QUERY_ACCEPTED);
+}
@@ -0,0 +1,82 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Bitset dominance engine for archives with many objectives.
+
+  Every member occupies a slot, a bit position in all bitsets. For
+  each objective the members are kept in an ordered tree, which gives
+  the rank of any value. The members with a value below a given rank
+  are the union of a precomputed prefix bitset (ranks below the last
+  multiple of the bucket size) and the few members of the partial
+  bucket. So the members that weakly dominate a vector are the AND
+  over the objectives of the members not above it, and the members it
+  weakly dominates the AND of the complements of those below it. A
+  test against the whole archive takes O(dim * (n/64 + bucket size +
+  log n)) word operations instead of O(dim * n) comparisons.
+
+  Inserting or removing a member moves one member across each bucket
+  boundary above its rank, so each prefix bitset changes in two bits.
+  The bucket size grows with the number of slots so that there are at
+  most BITSET_BUCKETS boundaries per objective.
+
+  Header file.
+
+  file: femo_bitset.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_BITSET_H
+#define FEMO_BITSET_H
+
+/*-------------------------| constants |--------------------------------*/
+
+#define BITSET_BUCKETS 256 /* boundaries per objective at most */
+
+#define BITSET_MIN_BUCKET 64 /* smallest bucket size */
+
+/*-------------------------| functions |--------------------------------*/
+
+int bitset_init(void);
+/* Sets up the engine for 'dimension' objectives, without members.
+   Returns 0 if successful and 1 otherwise. */
+
+void bitset_clear(void);
+/* Forgets all members, memory is kept. */
+
+void bitset_free(void);
+/* Frees all memory. */
+
+int bitset_reserve(int count);
+/* Makes room for 'count' members with handles below 'count', so that
+   adding members allocates nothing below it.
+   Returns 0 if successful and 1 if out of memory. */
+
+int bitset_update(int identity);
+/* Decides whether the new individual 'identity' (already in the
+   global population, no member with the same vector) enters the
+   archive. It is removed with femo_remove() if a member dominates it,
+   otherwise the members it dominates are.
+   Returns 0 if successful and 1 otherwise. */
+
+int bitset_adopt(int identity);
+/* Makes 'identity' a member without any test.
+   Returns 0 if successful and 1 if out of memory. */
+
+int bitset_remove(int identity);
+/* Removes the member 'identity'. It has to be called while the
+   individual still exists. Does nothing if it is not a member.
+   Returns 0. */
+
+int bitset_query(double *objective_value, int *removed);
+/* Compares a vector with the members, see femo_query(). */
+
+#endif /* FEMO_BITSET_H */
@@ -0,0 +1,282 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Bulk construction of the initial archive.
+
+  The filter works in place on the sorted identities: the nondominated
+  ones of a part are moved to its beginning, the first half keeps its
+  place and the survivors of the second half follow it. The threads
+  only read the global population, and each one marks a part of
+  'dropped' of its own. The buffers are only needed once per run and
+  are freed at the end.
+
+  C file.
+
+  file: femo_bulk.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_trace.h"
+#include "femo_bulk.h"
+
+#ifdef PISA_UNIX
+#include <unistd.h>
+#endif
+
+/*--------------------| global variable definitions |-------------------*/
+
+int bulk_threads = 0; /* threads of the bulk filter, 0 for one per
+                         processor */
+
+/* only used in this file */
+
+typedef struct bulk_task_t
+{
+     int first; /* part of 'order' */
+     int count;
+     int threads; /* threads the part may use */
+     int result; /* nondominated ones at the beginning of the part */
+} bulk_task;
+
+typedef struct bulk_check_t
+{
+     int first; /* positions to check */
+     int count;
+     int front_first; /* positions of the nondominated first half */
+     int front_count;
+} bulk_check;
+
+static int *order = NULL; /* identities, sorted */
+
+static char *dropped = NULL; /* 1 if the identity at this position is
+                                dominated */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static int compare_values(const void *a, const void *b)
+/* Compares the objective vectors of two identities lexicographically. */
+{
+     int k;
+     objective_t *x, *y;
+
+     x = get_individual(*(const int *) a)->objective_value;
+     y = get_individual(*(const int *) b)->objective_value;
+     for (k = 0; k < dimension; k++)
+     {
+          if (x[k] < y[k])
+               return (-1);
+          if (x[k] > y[k])
+               return (1);
+     }
+     return (0);
+}
+
+
+static int compare_ints(const void *a, const void *b)
+{
+     return (*(const int *) a - *(const int *) b);
+}
+
+
+static void *check_main(void *argument)
+/* Marks the positions of the check that are dominated by the front. */
+{
+     bulk_check *check = (bulk_check *) argument;
+     int i, j, identity;
+
+     for (i = check->first; i < check->first + check->count; i++)
+     {
+          identity = order[i];
+          dropped[i] = 0;
+          for (j = check->front_first;
+               j < check->front_first + check->front_count; j++)
+          {
+               if (dominates(order[j], identity, dimension))
+               {
+                    dropped[i] = 1;
+                    break;
+               }
+          }
+     }
+     return (NULL);
+}
+
+
+static void check_part(int first, int count, int front_first,
+                       int front_count, int threads)
+/* Marks the dominated positions, with up to 'threads' threads. */
+{
+     bulk_check checks[64];
+     pthread_t workers[64];
+     int started[64];
+     int i, part;
+
+     if (threads > 64)
+          threads = 64;
+     if (threads < 2 || count < threads)
+          threads = 1;
+     part = (count + threads - 1) / threads;
+     for (i = 0; i < threads; i++)
+     {
+          checks[i].first = first + i * part;
+          checks[i].count = i * part + part > count ? count - i * part : part;
+          if (checks[i].count < 0)
+               checks[i].count = 0;
+          checks[i].front_first = front_first;
+          checks[i].front_count = front_count;
+          started[i] = i > 0 && pthread_create(&workers[i], NULL,
+                                               check_main, &checks[i]) == 0;
+          if (i > 0 && !started[i])
+               check_main(&checks[i]); /* no thread, done here */
+     }
+     check_main(&checks[0]);
+     for (i = 1; i < threads; i++)
+     {
+          if (started[i])
+               pthread_join(workers[i], NULL);
+     }
+}
+
+
+static int filter_part(int first, int count, int threads);
+
+static void *filter_main(void *argument)
+{
+     bulk_task *task = (bulk_task *) argument;
+
+     task->result = filter_part(task->first, task->count, task->threads);
+     return (NULL);
+}
+
+
+static int filter_part(int first, int count, int threads)
+/* Moves the nondominated identities of the part to its beginning and
+   returns their number. */
+{
+     bulk_task task;
+     pthread_t worker;
+     int i, half, kept, second;
+
+     if (count <= 1)
+          return (count);
+     half = count / 2;
+     if (threads < 2 || count < BULK_PARALLEL_MIN)
+          threads = 1;
+
+     task.first = first;
+     task.count = half;
+     task.threads = threads / 2;
+     if (threads > 1 && pthread_create(&worker, NULL, filter_main,
+                                       &task) == 0)
+     {
+          second = filter_part(first + half, count - half,
+                               threads - threads / 2);
+          pthread_join(worker, NULL);
+     }
+     else
+     {
+          task.result = filter_part(first, half, threads);
+          second = filter_part(first + half, count - half, threads);
+     }
+
+     /* nothing in the second half dominates the first half */
+     check_part(first + half, second, first, task.result,
+                task.result * second >= BULK_PARALLEL_MIN ? threads : 1);
+     kept = task.result;
+     for (i = first + half; i < first + half + second; i++)
+     {
+          if (!dropped[i])
+               order[first + kept++] = order[i];
+     }
+     return (kept);
+}
+
+/*-------------------------| bulk functions |---------------------------*/
+
+int bulk_filter(int size, int *new_identity)
+/* Sorts, filters and removes the dominated ones. */
+{
+     int i, k, count, kept, threads;
+     objective_t *values;
+     double span_begin;
+
+     for (i = 0; i < size; i++)
+     {
+          if (get_individual(new_identity[i]) == NULL)
+               continue; /* equal to another one */
+          values = get_individual(new_identity[i])->objective_value;
+          for (k = 0; k < dimension; k++)
+          {
+               if (values[k] != values[k])
+                    return (2); /* NaN, no order */
+          }
+     }
+
+     threads = bulk_threads;
+#ifdef PISA_UNIX
+     if (threads == 0)
+          threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+     if (threads < 1)
+          threads = 1;
+
+     span_begin = trace_begin();
+     order = (int *) malloc((size + 1) * sizeof(int));
+     dropped = (char *) malloc(size + 1);
+     if (order == NULL || dropped == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          free(order);
+          free(dropped);
+          order = NULL;
+          dropped = NULL;
+          return (1);
+     }
+     count = 0;
+     for (i = 0; i < size; i++)
+     {
+          if (get_individual(new_identity[i]) != NULL)
+               order[count++] = new_identity[i];
+     }
+     qsort(order, count, sizeof(int), compare_values);
+     kept = filter_part(0, count, threads);
+     free(dropped);
+     dropped = NULL;
+
+     /* the ones not kept leave in the order of 'new_identity' */
+     qsort(order, kept, sizeof(int), compare_ints);
+     for (i = 0; i < size; i++)
+     {
+          if (get_individual(new_identity[i]) != NULL
+              && bsearch(&new_identity[i], order, kept, sizeof(int),
+                         compare_ints) == NULL
+              && femo_remove(new_identity[i]) != 0)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "removing individual failed");
+               free(order);
+               order = NULL;
+               return (1);
+          }
+     }
+     free(order);
+     order = NULL;
+     trace_end("bulk_filter", "select", span_begin);
+     return (0);
+}
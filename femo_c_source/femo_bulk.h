@@ -0,0 +1,62 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Bulk construction of the initial archive.
+
+  If all individuals in the global population are new (the initial
+  population in state 1), update_archive() doesn't insert them one by
+  one but keeps their nondominated ones with a divide and conquer
+  filter (Kung, Luccio and Preparata, On finding the maxima of a set
+  of vectors, 1975):
+
+  The individuals are sorted lexicographically by their objective
+  values. Equal vectors have been rejected before, so an individual
+  can only be dominated by one sorted before it. The sorted list is
+  split in halves, the nondominated ones of each half are found
+  recursively, and those of the second half that are dominated by one
+  of the first half are dropped.
+
+  With 'bulk_threads' greater than 1 both halves of a large list are
+  filtered in parallel, and the second half is checked against the
+  first one by several threads. The result doesn't depend on the
+  number of threads.
+
+  Header file.
+
+  file: femo_bulk.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_BULK_H
+#define FEMO_BULK_H
+
+/*-------------------------| constants |--------------------------------*/
+
+#define BULK_PARALLEL_MIN 512
+/* smallest list that is split among threads */
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int bulk_threads; /* threads of the bulk filter, 0 for one per
+                            processor */
+
+/*-------------------------| functions |--------------------------------*/
+
+int bulk_filter(int size, int *new_identity);
+/* Removes all individuals of 'new_identity' (already in the global
+   population, equal ones removed) that are dominated by another one
+   with femo_remove(). The archive must consist of these individuals
+   only.
+   Returns 0 if successful, 1 if an error occurred and 2 if an
+   objective value is NaN (nothing is removed then). */
+
+#endif /* FEMO_BULK_H */
@@ -0,0 +1,358 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Daemon mode (Linux only: epoll and signalfd).
+
+  SIGCHLD, SIGTERM and SIGINT are blocked in the daemon and read from
+  the signalfd, so the epoll loop is never interrupted by a handler.
+  selector_internal.h isn't included, its wait() would clash with the
+  one of <sys/wait.h>.
+
+  C file.
+
+  file: femo_daemon.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_session.h"
+#include "femo_daemon.h"
+
+#ifdef PISA_UNIX
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+
+/*-------------------------| sessions |---------------------------------*/
+
+#define DAEMON_MAX_SESSIONS 256 /* further clients get an ERROR */
+
+#define DAEMON_EVENTS 16 /* events taken from epoll_wait() at once */
+
+typedef struct daemon_session_t
+{
+     int slot_fd;  /* daemon's end of the slot socket pair, -1 if the
+                      entry is free */
+     int holding;  /* 1 while the session has a selection slot */
+     long waiting; /* ticket of its request for a slot, 0 if none */
+} daemon_session;
+
+/* only used in this file */
+
+static daemon_session sessions[DAEMON_MAX_SESSIONS];
+
+static int open_sessions = 0; /* entries in use */
+
+static int busy_slots = 0; /* sessions holding a slot */
+
+static long next_ticket = 1; /* slots are granted in the order asked */
+
+/*-------------------------| daemon functions |-------------------------*/
+
+static int watch(int epoll_fd, int fd, int on)
+/* Adds 'fd' to or removes it from the epoll set. */
+{
+     struct epoll_event event;
+
+     memset(&event, 0, sizeof(event));
+     event.events = EPOLLIN;
+     event.data.fd = fd;
+     return (epoll_ctl(epoll_fd, on ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, fd,
+                       &event) == 0 ? 0 : 1);
+}
+
+
+static void grant_slots(int workers)
+/* Grants free slots to the sessions waiting longest. */
+{
+     int i, next;
+     char byte = SLOT_GRANT;
+
+     while (busy_slots < workers)
+     {
+          next = -1;
+          for (i = 0; i < DAEMON_MAX_SESSIONS; i++)
+          {
+               if (sessions[i].slot_fd != -1 && sessions[i].waiting > 0
+                   && (next == -1
+                       || sessions[i].waiting < sessions[next].waiting))
+                    next = i;
+          }
+          if (next == -1)
+               return;
+          sessions[next].waiting = 0;
+          /* a session that has gone is dropped on its end of file */
+          if (write(sessions[next].slot_fd, &byte, 1) == 1)
+          {
+               sessions[next].holding = 1;
+               busy_slots++;
+          }
+     }
+}
+
+
+static void end_session(int epoll_fd, int i)
+/* Drops entry 'i' after its process has closed the socket pair. */
+{
+     if (sessions[i].holding)
+          busy_slots--;
+     watch(epoll_fd, sessions[i].slot_fd, 0);
+     close(sessions[i].slot_fd);
+     sessions[i].slot_fd = -1;
+     sessions[i].holding = 0;
+     sessions[i].waiting = 0;
+     open_sessions--;
+}
+
+
+static void serve_slots(int epoll_fd, int i)
+/* Reads the requests of session 'i'. */
+{
+     char bytes[16];
+     int j, n;
+
+     n = read(sessions[i].slot_fd, bytes, sizeof(bytes));
+     if (n < 0 && (errno == EINTR || errno == EAGAIN))
+          return;
+     if (n <= 0)
+     {
+          end_session(epoll_fd, i);
+          return;
+     }
+     for (j = 0; j < n; j++)
+     {
+          if (bytes[j] == SLOT_ACQUIRE && !sessions[i].holding)
+               sessions[i].waiting = next_ticket++;
+          else if (bytes[j] == SLOT_RELEASE && sessions[i].holding)
+          {
+               sessions[i].holding = 0;
+               busy_slots--;
+          }
+     }
+}
+
+
+static void start_session(int epoll_fd, int signal_fd, int listen_fd,
+                          int connection, sigset_t *mask, char *socket_path)
+/* Forks the process of a new session, or refuses the client. */
+{
+     int pair[2];
+     int i, status;
+     pid_t pid;
+
+     for (i = 0; i < DAEMON_MAX_SESSIONS; i++)
+     {
+          if (sessions[i].slot_fd == -1)
+               break;
+     }
+     if (i == DAEMON_MAX_SESSIONS)
+     {
+          session_refuse(connection, "too many sessions");
+          close(connection);
+          return;
+     }
+     if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+     {
+          session_refuse(connection, "couldn't start session");
+          close(connection);
+          return;
+     }
+
+     fflush(NULL); /* not to be written twice */
+     pid = fork();
+     if (pid == 0)
+     {
+          close(epoll_fd);
+          close(signal_fd);
+          close(listen_fd);
+          close(pair[0]);
+          for (i = 0; i < DAEMON_MAX_SESSIONS; i++)
+          {
+               if (sessions[i].slot_fd != -1)
+                    close(sessions[i].slot_fd);
+          }
+          sigprocmask(SIG_UNBLOCK, mask, NULL);
+          status = session_run(connection, pair[1], socket_path);
+          close(connection);
+          exit(status == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+     }
+     close(pair[1]);
+     if (pid == -1)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "couldn't start worker");
+          session_refuse(connection, "couldn't start session");
+          close(connection);
+          close(pair[0]);
+          return;
+     }
+     close(connection);
+     fcntl(pair[0], F_SETFL, fcntl(pair[0], F_GETFL) | O_NONBLOCK);
+     if (watch(epoll_fd, pair[0], 1) != 0)
+     {
+          /* the session gets no slot and ends */
+          close(pair[0]);
+          return;
+     }
+     sessions[i].slot_fd = pair[0];
+     sessions[i].holding = 0;
+     sessions[i].waiting = 0;
+     open_sessions++;
+}
+
+
+int daemon_run(char *socket_path, int workers)
+/* epoll loop: accepts sessions, grants the selection slots and reaps
+   finished sessions. */
+{
+     struct sockaddr_un address;
+     struct epoll_event events[DAEMON_EVENTS];
+     struct signalfd_siginfo info;
+     sigset_t mask;
+     int listen_fd, signal_fd, epoll_fd, connection;
+     int i, j, n, fd, status;
+     int stopping = 0; /* 1 after SIGTERM or SIGINT */
+
+     if (strlen(socket_path) >= sizeof(address.sun_path))
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "socket path too long");
+          return (1);
+     }
+     memset(&address, 0, sizeof(address));
+     address.sun_family = AF_UNIX;
+     strcpy(address.sun_path, socket_path);
+     for (i = 0; i < DAEMON_MAX_SESSIONS; i++)
+          sessions[i].slot_fd = -1;
+
+     listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+     if (listen_fd == -1)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "couldn't create socket");
+          return (1);
+     }
+     unlink(socket_path);
+     if (bind(listen_fd, (struct sockaddr *) &address, sizeof(address)) != 0
+         || listen(listen_fd, SOMAXCONN) != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't listen on socket");
+          close(listen_fd);
+          return (1);
+     }
+     fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+
+     /* a client that has gone makes writes fail instead of ending the
+        process */
+     signal(SIGPIPE, SIG_IGN);
+     sigemptyset(&mask);
+     sigaddset(&mask, SIGCHLD);
+     sigaddset(&mask, SIGTERM);
+     sigaddset(&mask, SIGINT);
+     sigprocmask(SIG_BLOCK, &mask, NULL);
+     signal_fd = signalfd(-1, &mask, 0);
+     epoll_fd = epoll_create(2);
+     if (signal_fd == -1 || epoll_fd == -1
+         || watch(epoll_fd, listen_fd, 1) != 0
+         || watch(epoll_fd, signal_fd, 1) != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't set up event loop");
+          close(listen_fd);
+          unlink(socket_path);
+          return (1);
+     }
+     daemon_enabled = 1;
+
+     while (!stopping || open_sessions > 0)
+     {
+          n = epoll_wait(epoll_fd, events, DAEMON_EVENTS, -1);
+          if (n < 0 && errno == EINTR)
+               continue;
+          if (n < 0)
+          {
+               log_to_file(log_file, __FILE__, __LINE__, "epoll_wait failed");
+               break;
+          }
+          for (i = 0; i < n; i++)
+          {
+               fd = events[i].data.fd;
+               if (fd == signal_fd)
+               {
+                    if (read(signal_fd, &info, sizeof(info)) != sizeof(info))
+                         continue;
+                    if (info.ssi_signo == SIGCHLD)
+                    {
+                         while (waitpid(-1, &status, WNOHANG) > 0)
+                              ;
+                    }
+                    else if (!stopping)
+                    {
+                         /* no new sessions, the running ones end */
+                         stopping = 1;
+                         watch(epoll_fd, listen_fd, 0);
+                    }
+               }
+               else if (fd == listen_fd)
+               {
+                    if (stopping)
+                         continue;
+                    connection = accept(listen_fd, NULL, NULL);
+                    if (connection == -1)
+                         continue; /* e.g. the client has gone already */
+                    start_session(epoll_fd, signal_fd, listen_fd, connection,
+                                  &mask, socket_path);
+               }
+               else
+               {
+                    for (j = 0; j < DAEMON_MAX_SESSIONS; j++)
+                    {
+                         if (sessions[j].slot_fd == fd)
+                         {
+                              serve_slots(epoll_fd, j);
+                              break;
+                         }
+                    }
+               }
+          }
+          grant_slots(workers);
+     }
+
+     while (waitpid(-1, &status, 0) > 0)
+          ;
+     close(epoll_fd);
+     close(signal_fd);
+     close(listen_fd);
+     unlink(socket_path);
+     return (0);
+}
+
+#else /* no daemon mode on other systems */
+
+int daemon_run(char *socket_path, int workers)
+{
+     log_to_file(log_file, __FILE__, __LINE__,
+                 "daemon mode needs Linux");
+     return (1);
+}
+
+#endif /* PISA_UNIX */
@@ -0,0 +1,45 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Daemon mode: FEMO listens on a Unix domain socket and runs one
+  optimization (session) per connection, without files and polling.
+
+  All archive data of FEMO is global, so every session runs in a
+  process of its own, forked when the connection is accepted. The
+  daemon itself runs an epoll loop over the listening socket, a
+  signalfd and one socket pair per session, over which it hands out
+  'workers' selection slots: a session holds a slot while it serves a
+  BATCH or a SEARCH, so at most 'workers' selections run at the same
+  time, however many sessions are open. Up to DAEMON_MAX_SESSIONS
+  (femo_daemon.c) sessions are open at once, a further client gets an
+  ERROR at once. See femo_session.h for the messages.
+
+  Header file.
+
+  file: femo_daemon.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_DAEMON_H
+#define FEMO_DAEMON_H
+
+/*-------------------------| functions |--------------------------------*/
+
+int daemon_run(char *socket_path, int workers);
+/* Listens on 'socket_path' (an existing socket file is replaced) and
+   serves sessions, of which up to 'workers' select at a time. The local
+   parameters are read from 'paramfile' for every session, the seed
+   is taken from the OPEN message. Returns after SIGTERM or SIGINT
+   once the running sessions have ended.
+   Returns 0 if successful and 1 otherwise. */
+
+#endif /* FEMO_DAEMON_H */
@@ -0,0 +1,240 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Hash set of objective vectors.
+
+  An open addressing table with linear probing stores identities
+  together with the hash of their objective vector. The vectors
+  themselves are not copied, they are compared through
+  get_objective_value().
+
+  C file.
+
+  file: femo_duplicates.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_duplicates.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int duplicates_enabled = 1; /* 0 while the ranks of femo_mpi reject
+                               equal vectors */
+
+/* only used in this file */
+
+static int *dup_table = NULL; /* identities, -1 for empty positions */
+
+static uint64_t *dup_hashes = NULL; /* hash of the vector at each position */
+
+static int dup_size = 0; /* power of 2, more than twice dup_count */
+
+static int dup_count = 0; /* number of identities in the set */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static int hash_vector(int identity, uint64_t *hash)
+/* Computes the hash of the objective vector of 'identity'.
+   Returns 0 if the vector contains NaN and 1 otherwise. */
+{
+     int k;
+     double value;
+     uint64_t h, bits;
+
+     h = 0x9e3779b97f4a7c15ULL;
+     for (k = 0; k < dimension; k++)
+     {
+          value = get_objective_value(identity, k);
+          if (value != value)
+               return (0);
+          if (value == 0)
+               value = 0.0; /* -0.0 */
+          memcpy(&bits, &value, sizeof(bits));
+          bits += h;
+          bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9ULL;
+          bits = (bits ^ (bits >> 27)) * 0x94d049bb133111ebULL;
+          h = bits ^ (bits >> 31);
+     }
+     *hash = h;
+     return (1);
+}
+
+
+static int probe(int identity, uint64_t hash)
+/* Returns the position of an individual with the same objective
+   vector as 'identity', or the empty position where it would be
+   stored. */
+{
+     int mask, position;
+
+     mask = dup_size - 1;
+     position = (int) (hash & mask);
+     while (dup_table[position] != -1
+            && (dup_hashes[position] != hash
+                || !is_equal(dup_table[position], identity, dimension)))
+          position = (position + 1) & mask;
+     return (position);
+}
+
+
+static int grow(int size)
+/* Enlarges the table to 'size' (a power of 2) positions.
+   Returns 0 if successful and 1 if out of memory. */
+{
+     int i, mask, position, old_size;
+     int *old_table;
+     uint64_t *old_hashes;
+
+     old_table = dup_table;
+     old_hashes = dup_hashes;
+     old_size = dup_size;
+
+     dup_size = size;
+     dup_table = (int *) malloc(dup_size * sizeof(int));
+     dup_hashes = (uint64_t *) malloc(dup_size * sizeof(uint64_t));
+     if (dup_table == NULL || dup_hashes == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          free(dup_table);
+          free(dup_hashes);
+          dup_table = old_table;
+          dup_hashes = old_hashes;
+          dup_size = old_size;
+          return (1);
+     }
+
+     for (i = 0; i < dup_size; i++)
+          dup_table[i] = -1;
+     mask = dup_size - 1;
+     for (i = 0; i < old_size; i++)
+     {
+          if (old_table[i] == -1)
+               continue;
+          position = (int) (old_hashes[i] & mask);
+          while (dup_table[position] != -1)
+               position = (position + 1) & mask;
+          dup_table[position] = old_table[i];
+          dup_hashes[position] = old_hashes[i];
+     }
+     free(old_table);
+     free(old_hashes);
+     return (0);
+}
+
+/*-------------------------| duplicate functions |----------------------*/
+
+int duplicate_reserve(int count)
+/* Grows the table like duplicate_insert() would. */
+{
+     int size;
+
+     if (!duplicates_enabled)
+          return (0);
+     size = dup_size == 0 ? 1024 : dup_size;
+     while (size < 2 * count)
+          size *= 2;
+     return (size > dup_size ? grow(size) : 0);
+}
+
+
+int duplicate_insert(int identity, int *equal)
+/* Adds 'identity' unless an equal vector is in the set. */
+{
+     int position;
+     uint64_t hash;
+
+     *equal = -1;
+     if (!duplicates_enabled || !hash_vector(identity, &hash))
+          return (0);
+
+     if (2 * (dup_count + 1) > dup_size
+         && grow(dup_size == 0 ? 1024 : dup_size * 2) != 0)
+          return (1);
+
+     position = probe(identity, hash);
+     if (dup_table[position] != -1)
+     {
+          *equal = dup_table[position];
+          return (0);
+     }
+     dup_table[position] = identity;
+     dup_hashes[position] = hash;
+     dup_count++;
+     return (0);
+}
+
+
+int duplicate_remove(int identity)
+/* Removes 'identity' and shifts the following entries back so that no
+   probe sequence is interrupted. */
+{
+     int mask, hole, next, home;
+     uint64_t hash;
+
+     if (dup_count == 0 || !hash_vector(identity, &hash))
+          return (0);
+
+     hole = probe(identity, hash);
+     if (dup_table[hole] != identity)
+          return (0);
+
+     mask = dup_size - 1;
+     next = hole;
+     for (;;)
+     {
+          next = (next + 1) & mask;
+          if (dup_table[next] == -1)
+               break;
+          home = (int) (dup_hashes[next] & mask);
+          /* move the entry if its home is not between hole and next */
+          if ((next > hole && (home <= hole || home > next))
+              || (next < hole && home <= hole && home > next))
+          {
+               dup_table[hole] = dup_table[next];
+               dup_hashes[hole] = dup_hashes[next];
+               hole = next;
+          }
+     }
+     dup_table[hole] = -1;
+     dup_count--;
+     return (0);
+}
+
+
+void duplicate_clear(void)
+/* Empties the set. */
+{
+     int i;
+
+     for (i = 0; i < dup_size; i++)
+          dup_table[i] = -1;
+     dup_count = 0;
+}
+
+
+void duplicate_free(void)
+/* Frees all memory. */
+{
+     free(dup_table);
+     free(dup_hashes);
+     dup_table = NULL;
+     dup_hashes = NULL;
+     dup_size = 0;
+     dup_count = 0;
+}
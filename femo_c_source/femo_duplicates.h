@@ -0,0 +1,58 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Hash set of the objective vectors in the global population, used to
+  reject individuals that are equal in all objective values to another
+  one in O(1) instead of scanning the archive with is_equal().
+
+  The key is the exact bit pattern of the objective vector, with -0.0
+  taken as +0.0 (they compare equal). Vectors containing NaN are never
+  equal to anything and are not stored.
+
+  Header file.
+
+  file: femo_duplicates.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_DUPLICATES_H
+#define FEMO_DUPLICATES_H
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int duplicates_enabled; /* 0 while the ranks of femo_mpi reject
+                                  equal vectors, the set stays empty */
+
+/*-------------------------| functions |--------------------------------*/
+
+int duplicate_reserve(int count);
+/* Makes room for 'count' identities, so that inserting allocates
+   nothing below it. Returns 0 if successful and 1 otherwise. */
+
+int duplicate_insert(int identity, int *equal);
+/* Looks for an individual with the same objective vector as
+   'identity'. If there is one, its identity is stored in '*equal' and
+   the set is unchanged. Otherwise 'identity' is added and '*equal' is
+   -1. Returns 0 if successful and 1 otherwise. */
+
+int duplicate_remove(int identity);
+/* Removes 'identity' from the set. It has to be called while the
+   individual still exists. Does nothing if it is not in the set.
+   Returns 0. */
+
+void duplicate_clear(void);
+/* Empties the set. */
+
+void duplicate_free(void);
+/* Frees all memory. */
+
+#endif /* FEMO_DUPLICATES_H */
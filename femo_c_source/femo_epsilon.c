@@ -0,0 +1,496 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Epsilon-dominance archive.
+
+  Every member occupies one slot holding its identity and its box
+  indices floor(f_i / epsilon_i). The slots are kept dense (a removed
+  slot is filled with the last one), so the box indices of all members
+  form one contiguous array. An open addressing hash table with linear
+  probing maps box indices to slots.
+
+  Since the occupied boxes do not dominate each other, a box is never
+  dominated by one member and dominating another one at the same time.
+  Both cases are therefore handled by one scan over the box array.
+
+  C file.
+
+  file: femo_epsilon.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_epsilon.h"
+#include "femo_query.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int epsilon_enabled = 0; /* 1 after epsilon_init() */
+
+/* only used in this file */
+
+static double *eps_size = NULL; /* box size along each objective */
+
+static long *eps_boxes = NULL; /* box indices, 'dimension' per slot */
+
+static unsigned long *eps_hashes = NULL; /* hash of the box of each slot */
+
+static int *eps_members = NULL; /* identity of the member in each slot */
+
+static int eps_count = 0; /* number of members */
+
+static int eps_capacity = 0; /* number of slots allocated */
+
+static int *eps_table = NULL; /* slot of each occupied box, -1 if empty */
+
+static int eps_table_size = 0; /* power of 2, more than twice eps_count */
+
+static long *eps_box = NULL; /* box of the individual being inserted */
+
+static long *eps_lookup = NULL; /* box of the individual being removed */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static void compute_box(int identity, long *box)
+{
+     int k;
+
+     for (k = 0; k < dimension; k++)
+          box[k] = (long) floor(get_objective_value(identity, k)
+                                / eps_size[k]);
+}
+
+
+static unsigned long hash_box(long *box)
+{
+     int k;
+     unsigned long h, x;
+
+     h = 0x9e3779b97f4a7c15UL;
+     for (k = 0; k < dimension; k++)
+     {
+          x = (unsigned long) box[k] + h;
+          x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+          x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+          h = x ^ (x >> 31);
+     }
+     return (h);
+}
+
+
+static int same_box(int slot, long *box)
+{
+     int k;
+     long *b;
+
+     b = &eps_boxes[slot * dimension];
+     for (k = 0; k < dimension; k++)
+          if (b[k] != box[k])
+               return (0);
+     return (1);
+}
+
+
+static int probe(long *box, unsigned long h)
+/* Returns the table position of 'box', or the empty position where it
+   would be stored. */
+{
+     int mask, position;
+
+     mask = eps_table_size - 1;
+     position = (int) (h & mask);
+     while (eps_table[position] != -1
+            && (eps_hashes[eps_table[position]] != h
+                || !same_box(eps_table[position], box)))
+          position = (position + 1) & mask;
+     return (position);
+}
+
+
+static int probe_slot(int slot)
+/* Returns the table position that refers to 'slot'. */
+{
+     int mask, position;
+
+     mask = eps_table_size - 1;
+     position = (int) (eps_hashes[slot] & mask);
+     while (eps_table[position] != slot)
+          position = (position + 1) & mask;
+     return (position);
+}
+
+
+static void table_delete(int position)
+/* Empties a table position and shifts the following entries back so
+   that no probe sequence is interrupted. */
+{
+     int mask, hole, next, home;
+
+     mask = eps_table_size - 1;
+     hole = position;
+     next = position;
+     for (;;)
+     {
+          next = (next + 1) & mask;
+          if (eps_table[next] == -1)
+               break;
+          home = (int) (eps_hashes[eps_table[next]] & mask);
+          /* move the entry if its home is not between hole and next */
+          if ((next > hole && (home <= hole || home > next))
+              || (next < hole && home <= hole && home > next))
+          {
+               eps_table[hole] = eps_table[next];
+               hole = next;
+          }
+     }
+     eps_table[hole] = -1;
+}
+
+
+static int grow_slots(int capacity)
+/* Makes room for 'capacity' members. Returns 0 if successful and 1 if
+   out of memory. */
+{
+     long *tmp_boxes;
+     unsigned long *tmp_hashes;
+     int *tmp_members;
+
+     tmp_boxes = (long *) realloc(eps_boxes, capacity * dimension
+                                  * sizeof(long));
+     if (tmp_boxes == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     eps_boxes = tmp_boxes;
+     tmp_hashes = (unsigned long *) realloc(eps_hashes, capacity
+                                            * sizeof(unsigned long));
+     if (tmp_hashes == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     eps_hashes = tmp_hashes;
+     tmp_members = (int *) realloc(eps_members, capacity * sizeof(int));
+     if (tmp_members == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     eps_members = tmp_members;
+     eps_capacity = capacity;
+     return (0);
+}
+
+
+static int grow_table(int size)
+/* Rebuilds the box table with 'size' (a power of 2) positions.
+   Returns 0 if successful and 1 if out of memory. */
+{
+     int i;
+
+     free(eps_table);
+     eps_table = (int *) malloc(size * sizeof(int));
+     if (eps_table == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          eps_table_size = 0;
+          return (1);
+     }
+     eps_table_size = size;
+     for (i = 0; i < eps_table_size; i++)
+          eps_table[i] = -1;
+     for (i = 0; i < eps_count; i++)
+          eps_table[probe(&eps_boxes[i * dimension], eps_hashes[i])] = i;
+     return (0);
+}
+
+
+static int ensure_capacity(void)
+/* Makes room for one more member. Returns 0 if successful and 1 if
+   out of memory. */
+{
+     if (eps_count == eps_capacity
+         && grow_slots(eps_capacity == 0 ? 256 : eps_capacity * 2) != 0)
+          return (1);
+     if (2 * (eps_count + 1) > eps_table_size
+         && grow_table(eps_table_size == 0 ? 512 : eps_table_size * 2) != 0)
+          return (1);
+     return (0);
+}
+
+
+static void remove_slot(int slot)
+/* Removes the member in 'slot' and fills the gap with the last slot. */
+{
+     int k, last;
+
+     table_delete(probe_slot(slot));
+     eps_count--;
+     last = eps_count;
+     if (slot != last)
+     {
+          eps_table[probe_slot(last)] = slot;
+          for (k = 0; k < dimension; k++)
+               eps_boxes[slot * dimension + k] = eps_boxes[last * dimension + k];
+          eps_hashes[slot] = eps_hashes[last];
+          eps_members[slot] = eps_members[last];
+     }
+}
+
+
+static int insert_member(int identity, long *box, unsigned long h)
+{
+     int k, position;
+
+     if (ensure_capacity() != 0)
+          return (1);
+     position = probe(box, h);
+     for (k = 0; k < dimension; k++)
+          eps_boxes[eps_count * dimension + k] = box[k];
+     eps_hashes[eps_count] = h;
+     eps_members[eps_count] = identity;
+     eps_table[position] = eps_count;
+     eps_count++;
+     return (0);
+}
+
+
+static double corner_distance(int identity, long *box)
+/* Squared distance to the lower corner of 'box', measured in box
+   sizes. */
+{
+     int k;
+     double d, distance;
+
+     distance = 0;
+     for (k = 0; k < dimension; k++)
+     {
+          d = get_objective_value(identity, k) / eps_size[k] - box[k];
+          distance += d * d;
+     }
+     return (distance);
+}
+
+/*-------------------------| epsilon functions |------------------------*/
+
+int epsilon_init(double *epsilon)
+/* Sets the box sizes and empties the box table. */
+{
+     int k;
+
+     epsilon_free();
+
+     eps_size = (double *) malloc(dimension * sizeof(double));
+     eps_box = (long *) malloc(dimension * sizeof(long));
+     eps_lookup = (long *) malloc(dimension * sizeof(long));
+     if (eps_size == NULL || eps_box == NULL || eps_lookup == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          free(eps_size);
+          free(eps_box);
+          free(eps_lookup);
+          eps_size = NULL;
+          eps_box = NULL;
+          eps_lookup = NULL;
+          return (1);
+     }
+     for (k = 0; k < dimension; k++)
+          eps_size[k] = epsilon[k];
+     epsilon_enabled = 1;
+     return (0);
+}
+
+
+void epsilon_clear(void)
+/* Empties the box table. */
+{
+     int i;
+
+     for (i = 0; i < eps_table_size; i++)
+          eps_table[i] = -1;
+     eps_count = 0;
+}
+
+
+void epsilon_free(void)
+/* Frees all memory. */
+{
+     free(eps_size);
+     free(eps_boxes);
+     free(eps_hashes);
+     free(eps_members);
+     free(eps_table);
+     free(eps_box);
+     free(eps_lookup);
+     eps_size = NULL;
+     eps_boxes = NULL;
+     eps_hashes = NULL;
+     eps_members = NULL;
+     eps_table = NULL;
+     eps_box = NULL;
+     eps_lookup = NULL;
+     eps_count = 0;
+     eps_capacity = 0;
+     eps_table_size = 0;
+     epsilon_enabled = 0;
+}
+
+
+int epsilon_reserve(int count)
+/* Makes room for 'count' members. */
+{
+     int size;
+
+     if (count > eps_capacity && grow_slots(count) != 0)
+          return (1);
+     size = eps_table_size == 0 ? 512 : eps_table_size;
+     while (size < 2 * count)
+          size *= 2;
+     if (size > eps_table_size && grow_table(size) != 0)
+          return (1);
+     return (0);
+}
+
+
+int epsilon_update(int identity)
+/* Lets the new individual 'identity' compete for its box. */
+{
+     int s, k, slot, member, below, above;
+     unsigned long h;
+     long *b;
+
+     compute_box(identity, eps_box);
+     h = hash_box(eps_box);
+
+     /* same box: keep the dominating point, or else the one closer to
+        the corner of the box (the member if both are equally close) */
+     slot = eps_table_size == 0 ? -1 : eps_table[probe(eps_box, h)];
+     if (slot != -1)
+     {
+          member = eps_members[slot];
+          if (dominates(identity, member, dimension)
+              || (!dominates(member, identity, dimension)
+                  && corner_distance(identity, eps_box)
+                  < corner_distance(member, eps_box)))
+          {
+               if (femo_remove(member) != 0)
+                    return (1);
+               return (insert_member(identity, eps_box, h));
+          }
+          return (femo_remove(identity));
+     }
+
+     /* other boxes: reject the individual if its box is dominated,
+        otherwise remove all members in boxes it dominates. Scanning
+        backwards, the slot moved into a gap has already been seen. */
+     for (s = eps_count - 1; s >= 0; s--)
+     {
+          b = &eps_boxes[s * dimension];
+          below = 1;
+          above = 1;
+          for (k = 0; k < dimension && (below || above); k++)
+          {
+               below = below && b[k] <= eps_box[k];
+               above = above && b[k] >= eps_box[k];
+          }
+          if (below)
+               return (femo_remove(identity));
+          if (above && femo_remove(eps_members[s]) != 0)
+               return (1);
+     }
+     return (insert_member(identity, eps_box, h));
+}
+
+
+int epsilon_remove(int identity)
+/* Removes 'identity' from the box table if it is a member. */
+{
+     int slot;
+
+     if (!epsilon_enabled || eps_count == 0)
+          return (0);
+
+     compute_box(identity, eps_lookup);
+     slot = eps_table[probe(eps_lookup, hash_box(eps_lookup))];
+     if (slot != -1 && eps_members[slot] == identity)
+          remove_slot(slot);
+     return (0);
+}
+
+
+int epsilon_query(double *objective_value, int *removed)
+/* Makes the decisions of epsilon_update() without changing anything. */
+{
+     int s, k, slot, member, below, above;
+     int a_is_worse, b_is_worse;
+     double d, candidate_distance;
+     long *b;
+
+     *removed = 0;
+     if (eps_count == 0)
+          return (QUERY_ACCEPTED);
+     for (k = 0; k < dimension; k++)
+          eps_lookup[k] = (long) floor(objective_value[k] / eps_size[k]);
+
+     slot = eps_table[probe(eps_lookup, hash_box(eps_lookup))];
+     if (slot != -1)
+     {
+          member = eps_members[slot];
+          a_is_worse = 0;
+          b_is_worse = 0;
+          candidate_distance = 0;
+          for (k = 0; k < dimension; k++)
+          {
+               a_is_worse |= objective_value[k]
+                    > get_objective_value(member, k);
+               b_is_worse |= get_objective_value(member, k)
+                    > objective_value[k];
+               d = objective_value[k] / eps_size[k] - eps_lookup[k];
+               candidate_distance += d * d;
+          }
+          /* no equal member here, see femo_query() */
+          if (!a_is_worse
+              || (b_is_worse && candidate_distance
+                  < corner_distance(member, eps_lookup)))
+          {
+               *removed = 1;
+               return (QUERY_ACCEPTED);
+          }
+          return (QUERY_DOMINATED);
+     }
+
+     for (s = 0; s < eps_count; s++)
+     {
+          b = &eps_boxes[s * dimension];
+          below = 1;
+          above = 1;
+          for (k = 0; k < dimension && (below || above); k++)
+          {
+               below = below && b[k] <= eps_lookup[k];
+               above = above && b[k] >= eps_lookup[k];
+          }
+          if (below)
+          {
+               *removed = 0;
+               return (QUERY_DOMINATED);
+          }
+          if (above)
+               (*removed)++;
+     }
+     return (QUERY_ACCEPTED);
+}
@@ -0,0 +1,73 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Epsilon-dominance archive (Laumanns, Thiele, Deb and Zitzler, 2002).
+
+  The objective space is divided into boxes of size epsilon_i along
+  objective i. The archive keeps at most one individual per box and
+  no box that is dominated by another occupied box, which guarantees
+  an epsilon-approximate Pareto front of bounded size.
+
+  The occupied boxes are stored in a hash table, so the member in the
+  box of a new individual is found in expected O(1). Box dominance is
+  decided on the box indices alone, which are kept in one contiguous
+  array.
+
+  Header file.
+
+  file: femo_epsilon.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_EPSILON_H
+#define FEMO_EPSILON_H
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int epsilon_enabled; /* 1 if the archive uses epsilon boxes */
+
+/*-------------------------| functions |--------------------------------*/
+
+int epsilon_init(double *epsilon);
+/* Sets the box sizes ('dimension' values > 0) and empties the box
+   table. Returns 0 if successful and 1 otherwise. */
+
+void epsilon_clear(void);
+/* Empties the box table. */
+
+void epsilon_free(void);
+/* Frees all memory, epsilon_enabled is 0 afterwards. */
+
+int epsilon_reserve(int count);
+/* Makes room for 'count' members, so that the box table allocates
+   nothing below it. Returns 0 if successful and 1 otherwise. */
+
+int epsilon_update(int identity);
+/* Decides whether the new individual 'identity' (already in the
+   global population) enters the archive. Rejected individuals and
+   members that are replaced or whose boxes are dominated are removed
+   with femo_remove().
+   Returns 0 if successful and 1 otherwise. */
+
+int epsilon_remove(int identity);
+/* Removes 'identity' from the box table. It has to be called while
+   the individual still exists. Does nothing if it is not a member.
+   Returns 0. */
+
+int epsilon_query(double *objective_value, int *removed);
+/* Tells what epsilon_update() would do with an individual whose
+   objective values are 'objective_value' (rounded like stored values,
+   no member with the same values). '*removed' is set to the number of
+   members it would replace or remove.
+   Returns QUERY_ACCEPTED or QUERY_DOMINATED (see femo_query.h). */
+
+#endif /* FEMO_EPSILON_H */
@@ -0,0 +1,199 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Columnar export of the archive.
+
+  The members are gathered column by column into two buffers kept for
+  the whole run, each column is written with one fwrite().
+
+  C file.
+
+  file: femo_export.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_trace.h"
+#include "femo_export.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+char export_file[FILE_NAME_LENGTH] = ""; /* columnar export, "" if none */
+
+int export_interval = 1; /* generations between exports, 0 for the end
+                            of the run only */
+
+/* only used in this file */
+
+#define EXPORT_MAGIC "FEMOCOL1"
+
+static int *export_ints = NULL; /* identity, owner or counter column */
+
+static int export_ints_size = 0;
+
+static objective_t *export_values = NULL; /* one objective column */
+
+static int export_values_size = 0;
+
+static int exported_generation = -1; /* generation in the file */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static long long padded(long long bytes)
+/* Rounds 'bytes' up to a multiple of 8. */
+{
+     return ((bytes + 7) / 8 * 8);
+}
+
+
+static int write_column(FILE *fp, void *column, long long bytes)
+/* Writes 'bytes' bytes of 'column' and pads them to a multiple of 8. */
+{
+     static const char zeros[8] = {0};
+
+     if (fwrite(column, 1, (size_t) bytes, fp) != (size_t) bytes)
+          return (1);
+     bytes = padded(bytes) - bytes;
+     return (fwrite(zeros, 1, (size_t) bytes, fp) == (size_t) bytes ? 0 : 1);
+}
+
+
+static int reserve_columns(int count)
+/* Makes both buffers hold 'count' entries. */
+{
+     objective_t *tmp;
+
+     if (grow_ints(&export_ints, &export_ints_size, count) != 0)
+          return (1);
+     if (export_values_size < count)
+     {
+          tmp = (objective_t *) realloc(export_values,
+                                        count * sizeof(objective_t));
+          if (tmp == NULL)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "selector out of memory");
+               return (1);
+          }
+          export_values = tmp;
+          export_values_size = count;
+     }
+     return (0);
+}
+
+/*-------------------------| export functions |-------------------------*/
+
+int export_reserve(int count)
+{
+     if (export_file[0] == '\0')
+          return (0);
+     return (reserve_columns(count));
+}
+
+
+int export_archive(int final)
+{
+     FILE *fp;
+     char temp_file[FILE_NAME_LENGTH + 4];
+     char header[EXPORT_HEADER_SIZE];
+     int fields[4];
+     long long offsets[4];
+     long long int_bytes, value_bytes;
+     int i, k, id, count, failed;
+     double span_begin;
+
+     if (export_file[0] == '\0' || exported_generation == generation)
+          return (0);
+     if (!final && (export_interval == 0
+                    || generation % export_interval != 0))
+          return (0);
+
+     span_begin = trace_begin();
+     count = get_size();
+     if (reserve_columns(count) != 0)
+          return (1);
+     int_bytes = padded((long long) count * sizeof(int));
+     value_bytes = padded((long long) count * sizeof(objective_t));
+
+     fields[0] = dimension;
+     fields[1] = count;
+     fields[2] = generation;
+     fields[3] = (int) sizeof(objective_t);
+     offsets[0] = EXPORT_HEADER_SIZE;
+     offsets[1] = offsets[0] + int_bytes;
+     offsets[2] = offsets[1] + int_bytes;
+     offsets[3] = offsets[2] + dimension * value_bytes;
+     memset(header, 0, sizeof(header));
+     memcpy(header, EXPORT_MAGIC, 8);
+     memcpy(header + 8, fields, sizeof(fields));
+     memcpy(header + 24, offsets, sizeof(offsets));
+
+     sprintf(temp_file, "%s.tmp", export_file);
+     fp = fopen(temp_file, "wb");
+     if (fp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't write export file");
+          return (1);
+     }
+     fwrite(header, 1, sizeof(header), fp);
+
+     i = 0;
+     for (id = get_first(); id != -1; id = get_next(id))
+          export_ints[i++] = get_local_identity(id);
+     write_column(fp, export_ints, (long long) count * sizeof(int));
+     i = 0;
+     for (id = get_first(); id != -1; id = get_next(id))
+          export_ints[i++] = get_owner(id);
+     write_column(fp, export_ints, (long long) count * sizeof(int));
+     for (k = 0; k < dimension; k++)
+     {
+          i = 0;
+          for (id = get_first(); id != -1; id = get_next(id))
+               export_values[i++] = get_individual(id)->objective_value[k];
+          write_column(fp, export_values,
+                       (long long) count * sizeof(objective_t));
+     }
+     i = 0;
+     for (id = get_first(); id != -1; id = get_next(id))
+          export_ints[i++] = get_individual(id)->counter;
+     write_column(fp, export_ints, (long long) count * sizeof(int));
+
+     failed = ferror(fp);
+     if (fclose(fp) != 0 || failed || rename(temp_file, export_file) != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't write export file");
+          return (1);
+     }
+     exported_generation = generation;
+     trace_end("export_archive", "io", span_begin);
+     return (0);
+}
+
+
+void export_free(void)
+{
+     free(export_ints);
+     free(export_values);
+     export_ints = NULL;
+     export_values = NULL;
+     export_ints_size = 0;
+     export_values_size = 0;
+     exported_generation = -1;
+}
@@ -0,0 +1,68 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Columnar export of the archive.
+
+  With 'export_file' the archive is written as a binary file with one
+  contiguous column per field, e.g. for numpy.memmap. The file is
+  written under '<export_file>.tmp' and renamed, so a reader never
+  sees a partial file.
+
+  Layout (native byte order, each column starts at a multiple of 8):
+
+    char magic[8]            "FEMOCOL1"
+    int dim, count, generation, value_size (8, or 4 with FLOAT=1)
+    long long offsets of the columns identity, owner, objectives and
+              counter (from the start of the file)
+    padding up to byte 64
+    int identity[count]      identities as used by the variator
+    int owner[count]         variator (position on the command line)
+    value objective[dim][count]  one column per objective
+    int counter[count]       times selected as parent
+
+  Header file.
+
+  file: femo_export.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_EXPORT_H
+#define FEMO_EXPORT_H
+
+/*-------------------------| constants |--------------------------------*/
+
+#define EXPORT_HEADER_SIZE 64
+/* bytes before the first column */
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern char export_file[]; /* columnar export, "" if none */
+
+extern int export_interval; /* generations between exports, 0 for
+                               the end of the run only */
+
+/*-------------------------| functions |--------------------------------*/
+
+int export_reserve(int count);
+/* Makes the column buffers hold 'count' members. Does nothing without
+   'export_file'. Returns 0 if successful and 1 otherwise. */
+
+int export_archive(int final);
+/* Writes the archive to 'export_file' if an export is due after this
+   generation, or if 'final' is 1 (end of the run). Does nothing
+   without 'export_file'.
+   Returns 0 if successful and 1 otherwise. */
+
+void export_free(void);
+/* Frees the column buffers. */
+
+#endif /* FEMO_EXPORT_H */
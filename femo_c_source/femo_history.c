@@ -0,0 +1,487 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Append-only history of the archive.
+
+  Whether an individual has been logged as a member is kept in a
+  byte array indexed by its handle, so removing a new individual that
+  was rejected doesn't produce an entry. The log is flushed at the
+  end of every generation, so after a crash it ends with complete
+  generations and possibly a part of the next one, which the reader
+  ignores.
+
+  C file.
+
+  file: femo_history.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_trace.h"
+#include "femo_history.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int history_keyframe = 100; /* generations between keyframes */
+
+/* only used in this file */
+
+#define HISTORY_MAGIC "FEMOHIS1"
+
+static FILE *history_fp = NULL; /* log being written, NULL if none */
+
+static FILE *index_fp = NULL; /* positions of the keyframes */
+
+static char *logged = NULL; /* 1 for handles logged as members */
+
+static int logged_size = 0;
+
+static double *history_values = NULL; /* objective values of one
+                                         member, 'dimension' */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static void write_entry(int type, int value)
+/* Appends the three ints of an entry. */
+{
+     int entry[3];
+
+     entry[0] = type;
+     entry[1] = generation;
+     entry[2] = value;
+     fwrite(entry, sizeof(int), 3, history_fp);
+}
+
+
+static void write_values(int identity)
+/* Appends the objective values of 'identity' as doubles. */
+{
+     int k;
+     objective_t *values;
+
+     values = get_individual(identity)->objective_value;
+     for (k = 0; k < dimension; k++)
+          history_values[k] = values[k];
+     fwrite(history_values, sizeof(double), dimension, history_fp);
+}
+
+
+static int grow_logged(int size)
+/* Makes 'logged' hold 'size' handles, at least doubling it.
+   Returns 0 if successful and 1 if out of memory. */
+{
+     char *tmp;
+     int new_size;
+
+     if (size <= logged_size)
+          return (0);
+     new_size = 2 * logged_size > size ? 2 * logged_size : size;
+     tmp = (char *) realloc(logged, new_size);
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     memset(tmp + logged_size, 0, new_size - logged_size);
+     logged = tmp;
+     logged_size = new_size;
+     return (0);
+}
+
+
+static int compare_ints(const void *a, const void *b)
+{
+     return (*(const int *) a > *(const int *) b)
+          - (*(const int *) a < *(const int *) b);
+}
+
+/*-------------------------| log functions |----------------------------*/
+
+int history_open(char *file)
+{
+     char index_file[FILE_NAME_LENGTH + 4];
+     int header[2];
+
+     history_close();
+     history_values = (double *) malloc(dimension * sizeof(double));
+     sprintf(index_file, "%s.idx", file);
+     history_fp = fopen(file, "wb");
+     index_fp = fopen(index_file, "wb");
+     if (history_values == NULL || history_fp == NULL || index_fp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't open history file");
+          history_close();
+          return (1);
+     }
+     header[0] = dimension;
+     header[1] = channel_count;
+     fwrite(HISTORY_MAGIC, 1, 8, history_fp);
+     fwrite(header, sizeof(int), 2, history_fp);
+     return (0);
+}
+
+
+int history_reserve(int count)
+{
+     if (history_fp == NULL)
+          return (0);
+     return (grow_logged(count));
+}
+
+
+int history_insert(int identity)
+{
+     int handle;
+
+     if (history_fp == NULL)
+          return (0);
+     handle = get_handle(identity);
+     if (grow_logged(handle + 1) != 0)
+          return (1);
+     logged[handle] = 1;
+     write_entry(HISTORY_INSERT, identity);
+     write_values(identity);
+     return (0);
+}
+
+
+int history_remove(int identity)
+{
+     int handle;
+
+     handle = get_handle(identity);
+     if (history_fp == NULL || handle < 0 || handle >= logged_size
+         || !logged[handle])
+          return (0);
+     logged[handle] = 0;
+     write_entry(HISTORY_REMOVE, identity);
+     return (0);
+}
+
+
+int history_commit(void)
+{
+     int identity;
+     long long offset;
+     double span_begin;
+
+     if (history_fp == NULL)
+          return (0);
+     span_begin = trace_begin();
+     if (generation % history_keyframe == 0)
+     {
+          offset = (long long) ftell(history_fp);
+          write_entry(HISTORY_KEYFRAME, get_size());
+          for (identity = get_first(); identity != -1;
+               identity = get_next(identity))
+          {
+               fwrite(&identity, sizeof(int), 1, history_fp);
+               write_values(identity);
+          }
+          fwrite(&generation, sizeof(int), 1, index_fp);
+          fwrite(&offset, sizeof(long long), 1, index_fp);
+          fflush(index_fp);
+     }
+     write_entry(HISTORY_END, get_size());
+     if (fflush(history_fp) != 0 || ferror(history_fp) || ferror(index_fp))
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't write history file");
+          return (1);
+     }
+     trace_end("history_commit", "io", span_begin);
+     return (0);
+}
+
+
+void history_close(void)
+{
+     if (history_fp != NULL)
+          fclose(history_fp);
+     if (index_fp != NULL)
+          fclose(index_fp);
+     history_fp = NULL;
+     index_fp = NULL;
+     free(logged);
+     free(history_values);
+     logged = NULL;
+     logged_size = 0;
+     history_values = NULL;
+}
+
+/*-------------------------| reader |-----------------------------------*/
+
+/* archive while reading, only used by history_run() and its helpers */
+
+static int *member_ids = NULL; /* identities of the members */
+
+static double *member_values = NULL; /* 'dim' values per member */
+
+static int member_count = 0;
+
+static int member_capacity = 0;
+
+static int *member_position = NULL; /* index in 'member_ids' by
+                                       identity, -1 if none */
+
+static int position_size = 0;
+
+
+static int reader_insert(int identity, double *values, int dim)
+/* Adds a member to the archive being reconstructed. */
+{
+     int *tmp_ids, *tmp_position;
+     double *tmp_values;
+     int i, new_size;
+
+     if (identity < 0)
+          return (1);
+     if (identity >= position_size)
+     {
+          new_size = 2 * position_size > identity ? 2 * position_size
+               : identity + 1;
+          tmp_position = (int *) realloc(member_position,
+                                         new_size * sizeof(int));
+          if (tmp_position == NULL)
+               return (1);
+          for (i = position_size; i < new_size; i++)
+               tmp_position[i] = -1;
+          member_position = tmp_position;
+          position_size = new_size;
+     }
+     if (member_position[identity] != -1)
+          return (1);
+     if (member_count == member_capacity)
+     {
+          new_size = member_capacity == 0 ? 256 : 2 * member_capacity;
+          tmp_ids = (int *) realloc(member_ids, new_size * sizeof(int));
+          if (tmp_ids == NULL)
+               return (1);
+          member_ids = tmp_ids;
+          tmp_values = (double *) realloc(member_values, (size_t) new_size
+                                          * dim * sizeof(double));
+          if (tmp_values == NULL)
+               return (1);
+          member_values = tmp_values;
+          member_capacity = new_size;
+     }
+     member_ids[member_count] = identity;
+     memcpy(&member_values[member_count * dim], values, dim * sizeof(double));
+     member_position[identity] = member_count;
+     member_count++;
+     return (0);
+}
+
+
+static int reader_remove(int identity, int dim)
+/* Removes a member, the last one takes its place. */
+{
+     int i;
+
+     if (identity < 0 || identity >= position_size
+         || member_position[identity] == -1)
+          return (1);
+     i = member_position[identity];
+     member_position[identity] = -1;
+     member_count--;
+     if (i != member_count)
+     {
+          member_ids[i] = member_ids[member_count];
+          memcpy(&member_values[i * dim], &member_values[member_count * dim],
+                 dim * sizeof(double));
+          member_position[member_ids[i]] = i;
+     }
+     return (0);
+}
+
+
+static void print_member(char *prefix, int identity, double *values,
+                         int dim, int channels)
+/* Prints one line: identity and variator, and the values if given. */
+{
+     int k;
+
+     printf("%s%d %d", prefix, identity / channels, identity % channels);
+     if (values != NULL)
+          for (k = 0; k < dim; k++)
+               printf(" %.17g", values[k]);
+     printf("\n");
+}
+
+
+static void free_reader(void)
+{
+     free(member_ids);
+     free(member_values);
+     free(member_position);
+     member_ids = NULL;
+     member_values = NULL;
+     member_position = NULL;
+     member_count = 0;
+     member_capacity = 0;
+     position_size = 0;
+}
+
+
+int history_run(char *file, int from, int to)
+{
+     FILE *fp, *idx;
+     char magic[8];
+     char index_file[FILE_NAME_LENGTH + 4];
+     int header[2], entry[3];
+     int dim, channels, i, identity, keyframe, sorted_count;
+     int last = -1; /* last complete generation */
+     int printed; /* last generation with a heading */
+     int error = 0;
+     long long offset, start;
+     double *values;
+     int *sorted;
+
+     fp = fopen(file, "rb");
+     if (fp == NULL || fread(magic, 1, 8, fp) != 8
+         || memcmp(magic, HISTORY_MAGIC, 8) != 0
+         || fread(header, sizeof(int), 2, fp) != 2
+         || header[0] <= 0 || header[1] <= 0)
+     {
+          printf("History: %s is not a FEMO history.\n", file);
+          if (fp != NULL)
+               fclose(fp);
+          return (1);
+     }
+     dim = header[0];
+     channels = header[1];
+
+     /* the last keyframe not after 'from', the start of the log
+        without index */
+     start = (long long) ftell(fp);
+     if (strlen(file) < FILE_NAME_LENGTH)
+     {
+          sprintf(index_file, "%s.idx", file);
+          idx = fopen(index_file, "rb");
+          if (idx != NULL)
+          {
+               while (fread(&keyframe, sizeof(int), 1, idx) == 1
+                      && fread(&offset, sizeof(long long), 1, idx) == 1
+                      && keyframe <= from)
+                    start = offset;
+               fclose(idx);
+          }
+     }
+     fseek(fp, (long) start, SEEK_SET);
+
+     values = (double *) malloc(dim * sizeof(double));
+     if (values == NULL)
+     {
+          fclose(fp);
+          return (1);
+     }
+     printed = from;
+     while (!error && last < to
+            && fread(entry, sizeof(int), 3, fp) == 3)
+     {
+          if (entry[1] > from && last < from)
+          {
+               error = 1; /* 'from' missing */
+               break;
+          }
+          if (entry[1] > printed)
+          {
+               printf("# generation %d\n", entry[1]);
+               printed = entry[1];
+          }
+          if (entry[0] == HISTORY_KEYFRAME)
+          {
+               if (entry[1] > from)
+               {
+                    /* redundant while streaming */
+                    fseek(fp, (long) entry[2] * (sizeof(int)
+                                                 + dim * sizeof(double)),
+                          SEEK_CUR);
+                    continue;
+               }
+               while (member_count > 0)
+                    reader_remove(member_ids[member_count - 1], dim);
+               for (i = 0; i < entry[2] && !error; i++)
+               {
+                    if (fread(&identity, sizeof(int), 1, fp) != 1
+                        || fread(values, sizeof(double), dim, fp)
+                        != (size_t) dim)
+                         break; /* incomplete */
+                    error = reader_insert(identity, values, dim);
+               }
+               if (i < entry[2])
+                    break;
+          }
+          else if (entry[0] == HISTORY_INSERT)
+          {
+               if (fread(values, sizeof(double), dim, fp) != (size_t) dim)
+                    break;
+               error = reader_insert(entry[2], values, dim);
+               if (!error && entry[1] > from)
+                    print_member("+ ", entry[2], values, dim, channels);
+          }
+          else if (entry[0] == HISTORY_REMOVE)
+          {
+               error = reader_remove(entry[2], dim);
+               if (!error && entry[1] > from)
+                    print_member("- ", entry[2], NULL, dim, channels);
+          }
+          else if (entry[0] == HISTORY_END)
+          {
+               if (entry[2] != member_count)
+                    error = 1;
+               last = entry[1];
+               if (last == from)
+               {
+                    /* the archive at 'from', ordered by identity */
+                    printf("# generation %d\n", from);
+                    sorted = (int *) malloc((member_count + 1) * sizeof(int));
+                    if (sorted == NULL)
+                    {
+                         error = 1;
+                         break;
+                    }
+                    sorted_count = member_count;
+                    memcpy(sorted, member_ids, sorted_count * sizeof(int));
+                    qsort(sorted, sorted_count, sizeof(int), compare_ints);
+                    for (i = 0; i < sorted_count; i++)
+                         print_member("", sorted[i], &member_values
+                                      [member_position[sorted[i]] * dim],
+                                      dim, channels);
+                    free(sorted);
+               }
+          }
+          else
+               error = 1;
+     }
+     fclose(fp);
+     free(values);
+     free_reader();
+
+     if (error || last < from)
+     {
+          if (last < from && !error)
+               printf("History: the log ends after generation %d.\n", last);
+          else
+               printf("History: generation %d can't be reconstructed.\n",
+                      from);
+          return (1);
+     }
+     return (0);
+}
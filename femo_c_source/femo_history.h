@@ -0,0 +1,94 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Append-only history of the archive.
+
+  With 'history_file' every change of the archive is appended to a
+  binary log: one entry when an individual becomes a member, one when
+  a member is removed, and one at the end of every generation. Every
+  'history_keyframe' generations the complete archive follows, and its
+  position is appended to '<history_file>.idx'.
+
+  'femo -history file g' prints the archive after generation 'g',
+  'femo -history file g1 g2' the archive after 'g1' and then the
+  changes of every generation up to 'g2'. Both start at the nearest
+  keyframe before 'g' or 'g1'.
+
+  Layout (native byte order, no padding):
+
+    "FEMOHIS1", int dim, int channel_count
+    entries: int type, int generation, int value
+      HISTORY_INSERT    value = identity, dim doubles
+      HISTORY_REMOVE    value = identity
+      HISTORY_KEYFRAME  value = count, count times (int identity,
+                        dim doubles)
+      HISTORY_END       value = archive size, generation complete
+    '.idx' file: per keyframe int generation, long long offset
+
+  The identities are the global ones, identity / channel_count is the
+  one used by the variator and identity % channel_count its variator.
+
+  Header file.
+
+  file: femo_history.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_HISTORY_H
+#define FEMO_HISTORY_H
+
+/*-------------------------| constants |--------------------------------*/
+
+#define HISTORY_INSERT 1
+#define HISTORY_REMOVE 2
+#define HISTORY_KEYFRAME 3
+#define HISTORY_END 4
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int history_keyframe; /* generations between keyframes */
+
+/*-------------------------| functions |--------------------------------*/
+
+int history_open(char *file);
+/* Starts a new log in 'file' and its index.
+   Returns 0 if successful and 1 otherwise. */
+
+int history_reserve(int count);
+/* Makes room for 'count' members with handles below 'count'. Does
+   nothing without a log. Returns 0 if successful and 1 otherwise. */
+
+int history_insert(int identity);
+/* Logs that 'identity' has become an archive member. Does nothing
+   without a log.
+   Returns 0 if successful and 1 otherwise. */
+
+int history_remove(int identity);
+/* Logs that 'identity' has left the archive. Does nothing without a
+   log or if it hasn't been logged as a member (e.g. a rejected new
+   individual). Must be called while the individual still exists.
+   Returns 0 if successful and 1 otherwise. */
+
+int history_commit(void);
+/* Ends the current generation, with a keyframe if one is due, and
+   flushes the log. Does nothing without a log.
+   Returns 0 if successful and 1 otherwise. */
+
+void history_close(void);
+/* Closes the log and frees all memory. */
+
+int history_run(char *file, int from, int to);
+/* Prints the archive after generation 'from' and the changes up to
+   generation 'to' (see above).
+   Returns 0 if successful and 1 otherwise. */
+
+#endif /* FEMO_HISTORY_H */
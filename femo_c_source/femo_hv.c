@@ -0,0 +1,654 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Hypervolume of the archive.
+
+  The WFG algorithm (While, Bradstreet and Barone, 2012) sorts the
+  points by their last objective, worst first. Then the limit set of a
+  point only contains points that share its last objective value, so
+  every recursion level works in one dimension less. Three dimensions
+  are handled by a sweep over the third objective that keeps the two
+  dimensional front in a tree (O(n log n)), two dimensions by a simple
+  sweep.
+
+  The recursion needs scratch space for the limit sets. It is taken
+  from a stack ('hv_arena') that only grows, so once it has reached
+  its working size no more memory is allocated. Since the stack may
+  move when it grows, the recursion refers to points by offsets.
+
+  C file.
+
+  file: femo_hv.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_tree.h"
+#include "femo_hv.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int hv_enabled = 0; /* 1 if a reference point has been set */
+
+/* only used in this file */
+
+static double *hv_reference = NULL; /* reference point */
+
+static double *hv_point = NULL; /* objective values of one individual */
+
+static double hv_volume = 0; /* hypervolume of the point set */
+
+/* two objectives: members sorted by the first objective */
+
+static tree hv_tree;
+
+/* three and more objectives: objective values of all members */
+
+static double *hv_points = NULL; /* 'hv_count' rows of 'dimension' values */
+
+static int *hv_identities = NULL; /* identity of each row */
+
+static int hv_count = 0;
+
+static int hv_capacity = 0;
+
+/* scratch stack for the WFG recursion */
+
+static double *hv_arena = NULL;
+
+static long hv_arena_size = 0;
+
+static long hv_arena_top = 0;
+
+static int hv_sort_column; /* column compared by the qsort() callbacks */
+
+static tree hv_sweep; /* two dimensional front of the 3d sweep */
+
+static double *hv_reference_2d; /* reference point of the 3d sweep */
+
+static int hv_failed = 0; /* 1 if the scratch memory ran out; a volume
+                             can't tell, rounding may make it slightly
+                             negative */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static int grow_arena(long size)
+/* Makes the scratch stack hold 'size' values, at least doubling it.
+   Returns 0 if successful and 1 if out of memory. */
+{
+     long new_size;
+     double *tmp;
+
+     if (size <= hv_arena_size)
+          return (0);
+     new_size = hv_arena_size == 0 ? 1024 : hv_arena_size;
+     while (new_size < size)
+          new_size *= 2;
+     tmp = (double *) realloc(hv_arena, new_size * sizeof(double));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     hv_arena = tmp;
+     hv_arena_size = new_size;
+     return (0);
+}
+
+
+static int grow_points(int capacity)
+/* Makes room for 'capacity' rows of 'hv_points'.
+   Returns 0 if successful and 1 if out of memory. */
+{
+     double *tmp_points;
+     int *tmp_identities;
+
+     tmp_points = (double *) realloc(hv_points, (long) capacity
+                                     * dimension * sizeof(double));
+     if (tmp_points == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     hv_points = tmp_points;
+     tmp_identities = (int *) realloc(hv_identities, capacity * sizeof(int));
+     if (tmp_identities == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     hv_identities = tmp_identities;
+     hv_capacity = capacity;
+     return (0);
+}
+
+
+static long arena_push(long count)
+/* Reserves 'count' values on the scratch stack and returns their
+   offset, -1 if out of memory. */
+{
+     long offset;
+
+     if (grow_arena(hv_arena_top + count) != 0)
+     {
+          hv_failed = 1;
+          return (-1);
+     }
+     offset = hv_arena_top;
+     hv_arena_top += count;
+     return (offset);
+}
+
+
+static int compare_ascending(const void *a, const void *b)
+{
+     double x = ((const double *) a)[hv_sort_column];
+     double y = ((const double *) b)[hv_sort_column];
+     return ((x > y) - (x < y));
+}
+
+
+static int compare_descending(const void *a, const void *b)
+{
+     double x = ((const double *) a)[hv_sort_column];
+     double y = ((const double *) b)[hv_sort_column];
+     return ((x < y) - (x > y));
+}
+
+
+static int weakly_dominates(double *a, double *b, int dim)
+/* Returns 1 if 'a' is not worse than 'b' in any objective. */
+{
+     int i;
+
+     for (i = 0; i < dim; i++)
+          if (a[i] > b[i])
+               return (0);
+     return (1);
+}
+
+
+static int filter_nondominated(double *rows, int size, int dim)
+/* Removes all rows that are weakly dominated by another row (one copy
+   of equal rows is kept). Returns the number of remaining rows, which
+   are moved to the front. */
+{
+     int i, j, kept, count;
+     int dominated;
+     double *row;
+
+     count = 0;
+     for (i = 0; i < size; i++)
+     {
+          row = rows + (long) i * dim;
+          dominated = 0;
+          for (j = 0; j < count && !dominated; j++)
+               dominated = weakly_dominates(rows + (long) j * dim, row, dim);
+          if (dominated)
+               continue;
+
+          /* drop the kept rows that 'row' dominates */
+          kept = 0;
+          for (j = 0; j < count; j++)
+          {
+               if (!weakly_dominates(row, rows + (long) j * dim, dim))
+               {
+                    if (kept != j)
+                         memcpy(rows + (long) kept * dim,
+                                rows + (long) j * dim, dim * sizeof(double));
+                    kept++;
+               }
+          }
+          count = kept;
+          if (count != i)
+               memmove(rows + (long) count * dim, row, dim * sizeof(double));
+          count++;
+     }
+     return (count);
+}
+
+
+static double sweep_contribution(double *points, int n)
+/* Area that node 'n' of 'hv_sweep' adds to the two dimensional front
+   formed by the other nodes. */
+{
+     int prev, next;
+     double x_next, y_prev;
+     double *p;
+
+     p = points + 3 * (long) TREE_IDENTITY(&hv_sweep, n);
+     prev = tree_lower(&hv_sweep, p[0], TREE_IDENTITY(&hv_sweep, n));
+     next = tree_higher(&hv_sweep, p[0], TREE_IDENTITY(&hv_sweep, n));
+     y_prev = prev == -1 ? hv_reference_2d[1]
+          : points[3 * (long) TREE_IDENTITY(&hv_sweep, prev) + 1];
+     x_next = next == -1 ? hv_reference_2d[0] : TREE_KEY(&hv_sweep, next);
+     return ((x_next - p[0]) * (y_prev - p[1]));
+}
+
+
+static double sweep3d(double *points, int size, double *reference)
+/* Hypervolume of 'size' points with three objectives, all better than
+   'reference'. Returns -1 and sets 'hv_failed' if out of memory. */
+{
+     int i, prev, next;
+     double area, volume;
+     double *p;
+
+     hv_sort_column = 2;
+     qsort(points, size, 3 * sizeof(double), compare_ascending);
+
+     hv_reference_2d = reference;
+     tree_clear(&hv_sweep);
+     area = 0;
+     volume = 0;
+     for (i = 0; i < size; i++)
+     {
+          /* points are identified by their row, every row already in
+             the tree is smaller than i */
+          p = points + 3 * (long) i;
+          prev = tree_lower(&hv_sweep, p[0], i);
+          if (prev == -1
+              || points[3 * (long) TREE_IDENTITY(&hv_sweep, prev) + 1] > p[1])
+          {
+               /* p is not dominated: remove the points it dominates */
+               while (prev != -1 && TREE_KEY(&hv_sweep, prev) == p[0])
+               {
+                    area -= sweep_contribution(points, prev);
+                    tree_remove(&hv_sweep, TREE_KEY(&hv_sweep, prev),
+                                TREE_IDENTITY(&hv_sweep, prev));
+                    prev = tree_lower(&hv_sweep, p[0], i);
+               }
+               next = tree_higher(&hv_sweep, p[0], i);
+               while (next != -1
+                      && points[3 * (long) TREE_IDENTITY(&hv_sweep, next) + 1]
+                      >= p[1])
+               {
+                    area -= sweep_contribution(points, next);
+                    tree_remove(&hv_sweep, TREE_KEY(&hv_sweep, next),
+                                TREE_IDENTITY(&hv_sweep, next));
+                    next = tree_higher(&hv_sweep, p[0], i);
+               }
+               if (tree_insert(&hv_sweep, p[0], i) != 0)
+               {
+                    hv_failed = 1;
+                    return (-1);
+               }
+               area += sweep_contribution(points,
+                                          tree_find(&hv_sweep, p[0], i));
+          }
+          if (i + 1 < size)
+               volume += area * (p[5] - p[2]);
+          else
+               volume += area * (reference[2] - p[2]);
+     }
+     return (volume);
+}
+
+
+static double wfg(long offset, int size, int dim, double *reference)
+/* Hypervolume of 'size' points at 'offset' on the scratch stack. All
+   points must be better than 'reference' in every objective.
+   Returns -1 and sets 'hv_failed' if out of memory. */
+{
+     int i, j, k, count;
+     long limit_offset;
+     double *points, *p, *q, *limit;
+     double volume, inclusive, sub, min_y;
+
+     if (size == 0)
+          return (0);
+
+     points = hv_arena + offset;
+
+     if (dim == 1)
+     {
+          min_y = points[0];
+          for (i = 1; i < size; i++)
+               if (points[i] < min_y)
+                    min_y = points[i];
+          return (reference[0] - min_y);
+     }
+
+     if (dim == 2)
+     {
+          hv_sort_column = 0;
+          qsort(points, size, 2 * sizeof(double), compare_ascending);
+          volume = 0;
+          min_y = reference[1];
+          for (i = 0; i < size; i++)
+          {
+               if (points[2 * i + 1] < min_y)
+               {
+                    volume += (reference[0] - points[2 * i])
+                         * (min_y - points[2 * i + 1]);
+                    min_y = points[2 * i + 1];
+               }
+          }
+          return (volume);
+     }
+
+     if (dim == 3)
+          return (sweep3d(points, size, reference));
+
+     hv_sort_column = dim - 1;
+     qsort(points, size, dim * sizeof(double), compare_descending);
+
+     volume = 0;
+     for (k = 0; k < size; k++)
+     {
+          /* limit set of point k, projected to the first dim-1 objectives */
+          limit_offset = arena_push((long) (size - k - 1) * (dim - 1));
+          if (limit_offset < 0)
+               return (-1);
+          points = hv_arena + offset; /* the stack may have moved */
+          p = points + (long) k * dim;
+          limit = hv_arena + limit_offset;
+          for (i = k + 1; i < size; i++)
+          {
+               q = points + (long) i * dim;
+               for (j = 0; j < dim - 1; j++)
+                    limit[(long) (i - k - 1) * (dim - 1) + j] =
+                         p[j] > q[j] ? p[j] : q[j];
+          }
+          count = size - k - 1;
+          if (dim - 1 > 3)
+               count = filter_nondominated(limit, count, dim - 1);
+
+          sub = wfg(limit_offset, count, dim - 1, reference);
+          hv_arena_top = limit_offset;
+          if (hv_failed)
+               return (-1);
+
+          p = hv_arena + offset + (long) k * dim;
+          inclusive = 1;
+          for (j = 0; j < dim - 1; j++)
+               inclusive *= reference[j] - p[j];
+          volume += (reference[dim - 1] - p[dim - 1]) * (inclusive - sub);
+     }
+     return (volume);
+}
+
+
+static double exclusive_contribution(double *point, int skip)
+/* Volume dominated by 'point' but by no row of 'hv_points' except
+   row 'skip' (use -1 to compare with all rows).
+   Returns -1 and sets 'hv_failed' if out of memory. */
+{
+     int i, j, count;
+     long offset;
+     double *limit, *q;
+     double inclusive, sub;
+
+     offset = arena_push((long) hv_count * dimension);
+     if (offset < 0)
+          return (-1);
+
+     limit = hv_arena + offset;
+     count = 0;
+     for (i = 0; i < hv_count; i++)
+     {
+          if (i == skip)
+               continue;
+          q = hv_points + (long) i * dimension;
+          for (j = 0; j < dimension; j++)
+               limit[(long) count * dimension + j] =
+                    point[j] > q[j] ? point[j] : q[j];
+          count++;
+     }
+     if (dimension > 3)
+          count = filter_nondominated(limit, count, dimension);
+
+     sub = wfg(offset, count, dimension, hv_reference);
+     hv_arena_top = offset;
+     if (hv_failed)
+          return (-1);
+
+     inclusive = 1;
+     for (j = 0; j < dimension; j++)
+          inclusive *= hv_reference[j] - point[j];
+     return (inclusive - sub);
+}
+
+
+static int read_point(int identity)
+/* Copies the objective values of 'identity' to 'hv_point'.
+   Returns 1 if the point lies inside the reference box. */
+{
+     int i;
+     int inside = 1;
+
+     for (i = 0; i < dimension; i++)
+     {
+          hv_point[i] = get_objective_value(identity, i);
+          if (hv_point[i] >= hv_reference[i])
+               inside = 0;
+     }
+     return (inside);
+}
+
+/*-------------------------| hypervolume functions |--------------------*/
+
+int hv_init(double *reference)
+/* Sets the reference point and empties the point set. */
+{
+     int i;
+
+     hv_free();
+
+     hv_reference = (double *) malloc(dimension * sizeof(double));
+     hv_point = (double *) malloc(dimension * sizeof(double));
+     if (hv_reference == NULL || hv_point == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          hv_free();
+          return (1);
+     }
+     for (i = 0; i < dimension; i++)
+          hv_reference[i] = reference[i];
+
+     tree_init(&hv_tree);
+     tree_init(&hv_sweep);
+     hv_enabled = 1;
+     return (0);
+}
+
+
+void hv_clear(void)
+/* Empties the point set. */
+{
+     tree_clear(&hv_tree);
+     hv_count = 0;
+     hv_volume = 0;
+}
+
+
+void hv_free(void)
+/* Frees all memory. */
+{
+     if (hv_enabled)
+     {
+          tree_free(&hv_tree);
+          tree_free(&hv_sweep);
+     }
+     free(hv_reference);
+     free(hv_point);
+     free(hv_points);
+     free(hv_identities);
+     free(hv_arena);
+     hv_reference = NULL;
+     hv_point = NULL;
+     hv_points = NULL;
+     hv_identities = NULL;
+     hv_arena = NULL;
+     hv_count = 0;
+     hv_capacity = 0;
+     hv_arena_size = 0;
+     hv_arena_top = 0;
+     hv_volume = 0;
+     hv_enabled = 0;
+}
+
+
+int hv_reserve(int count)
+/* Makes room for 'count' points. An exclusive contribution needs a
+   limit set of at most 'count' points per objective it recurses over,
+   down to three objectives (the sweep). */
+{
+     if (!hv_enabled)
+          return (0);
+     if (dimension == 2)
+          return (tree_reserve(&hv_tree, count));
+     if ((count > hv_capacity && grow_points(count) != 0)
+         || tree_reserve(&hv_sweep, count) != 0
+         || grow_arena((long) count * dimension * (dimension + 1) / 2) != 0)
+          return (1);
+     return (0);
+}
+
+
+int hv_insert(int identity)
+/* Adds the archive member 'identity' to the point set. */
+{
+     int i, prev, next;
+     double x_next, y_prev, contribution;
+
+     if (!hv_enabled || !read_point(identity))
+          return (0);
+
+     if (dimension == 2)
+     {
+          prev = tree_lower(&hv_tree, hv_point[0], identity);
+          next = tree_higher(&hv_tree, hv_point[0], identity);
+          y_prev = prev == -1 ? hv_reference[1]
+               : get_objective_value(TREE_IDENTITY(&hv_tree, prev), 1);
+          x_next = next == -1 ? hv_reference[0] : TREE_KEY(&hv_tree, next);
+
+          if (tree_insert(&hv_tree, hv_point[0], identity) != 0)
+               return (1);
+          hv_volume += (x_next - hv_point[0]) * (y_prev - hv_point[1]);
+          return (0);
+     }
+
+     hv_failed = 0;
+     contribution = exclusive_contribution(hv_point, -1);
+     if (hv_failed)
+          return (1);
+
+     if (hv_count == hv_capacity
+         && grow_points(hv_capacity == 0 ? 64 : hv_capacity * 2) != 0)
+          return (1);
+
+     for (i = 0; i < dimension; i++)
+          hv_points[(long) hv_count * dimension + i] = hv_point[i];
+     hv_identities[hv_count] = identity;
+     hv_count++;
+     hv_volume += contribution;
+     return (0);
+}
+
+
+int hv_remove(int identity)
+/* Removes the archive member 'identity' from the point set. */
+{
+     int i, prev, next;
+     double x_next, y_prev, contribution;
+
+     if (!hv_enabled)
+          return (0);
+
+     if (dimension == 2)
+     {
+          read_point(identity);
+          if (tree_find(&hv_tree, hv_point[0], identity) == -1)
+               return (0);
+
+          prev = tree_lower(&hv_tree, hv_point[0], identity);
+          next = tree_higher(&hv_tree, hv_point[0], identity);
+          y_prev = prev == -1 ? hv_reference[1]
+               : get_objective_value(TREE_IDENTITY(&hv_tree, prev), 1);
+          x_next = next == -1 ? hv_reference[0] : TREE_KEY(&hv_tree, next);
+
+          tree_remove(&hv_tree, hv_point[0], identity);
+          hv_volume -= (x_next - hv_point[0]) * (y_prev - hv_point[1]);
+          return (0);
+     }
+
+     for (i = 0; i < hv_count; i++)
+          if (hv_identities[i] == identity)
+               break;
+     if (i == hv_count)
+          return (0);
+
+     hv_failed = 0;
+     contribution = exclusive_contribution(hv_points + (long) i * dimension,
+                                           i);
+     if (hv_failed)
+          return (1);
+     hv_volume -= contribution;
+
+     /* move the last row into the gap */
+     hv_count--;
+     if (i != hv_count)
+     {
+          memcpy(hv_points + (long) i * dimension,
+                 hv_points + (long) hv_count * dimension,
+                 dimension * sizeof(double));
+          hv_identities[i] = hv_identities[hv_count];
+     }
+     return (0);
+}
+
+
+double hv_value(void)
+{
+     return (hv_volume);
+}
+
+
+double hv_compute(double *points, int size, int dim, double *reference)
+/* Computes the hypervolume of 'size' points from scratch. */
+{
+     int i, j, count, inside;
+     long offset, base;
+     double volume;
+
+     hv_failed = 0;
+     base = hv_arena_top;
+     offset = arena_push((long) size * dim);
+     if (offset < 0)
+          return (-1);
+
+     count = 0;
+     for (i = 0; i < size; i++)
+     {
+          inside = 1;
+          for (j = 0; j < dim; j++)
+          {
+               hv_arena[offset + (long) count * dim + j] =
+                    points[(long) i * dim + j];
+               if (points[(long) i * dim + j] >= reference[j])
+                    inside = 0;
+          }
+          count += inside;
+     }
+     if (dim > 3)
+          count = filter_nondominated(hv_arena + offset, count, dim);
+
+     volume = wfg(offset, count, dim, reference);
+     hv_arena_top = base;
+     return (hv_failed ? -1 : volume);
+}
@@ -0,0 +1,74 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Hypervolume of the archive, kept up to date while individuals are
+  added to and removed from the archive.
+
+  For two objectives the archive members are kept in a tree sorted by
+  the first objective. The contribution of a point only depends on its
+  two neighbours, so an update takes O(log n). For three and more
+  objectives the exclusive contribution of the added or removed point
+  is computed exactly with the WFG algorithm.
+
+  All objectives are minimized. Points that are not better than the
+  reference point in every objective do not contribute.
+
+  Header file.
+
+  file: femo_hv.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_HV_H
+#define FEMO_HV_H
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int hv_enabled; /* 1 if a reference point has been set */
+
+/*-------------------------| functions |--------------------------------*/
+
+int hv_init(double *reference);
+/* Sets the reference point ('dimension' values) and empties the
+   point set. Returns 0 if successful and 1 otherwise. */
+
+void hv_clear(void);
+/* Empties the point set, the reference point is kept. */
+
+void hv_free(void);
+/* Frees all memory, hv_enabled is 0 afterwards. */
+
+int hv_reserve(int count);
+/* Makes room for 'count' members, so that adding members and their
+   contributions allocate nothing below it.
+   Returns 0 if successful and 1 otherwise. */
+
+int hv_insert(int identity);
+/* Adds the archive member 'identity' to the point set. It must
+   neither dominate nor be dominated by any point in the set.
+   Returns 0 if successful and 1 otherwise. */
+
+int hv_remove(int identity);
+/* Removes the archive member 'identity' from the point set. It has to
+   be called while the individual still exists. Does nothing if the
+   member is not in the set.
+   Returns 0 if successful and 1 otherwise. */
+
+double hv_value(void);
+/* Returns the hypervolume of the point set. */
+
+double hv_compute(double *points, int size, int dim, double *reference);
+/* Computes the hypervolume of 'size' points (stored row by row in
+   'points') from scratch. The points need not be nondominated.
+   Returns -1 if out of memory. */
+
+#endif /* FEMO_HV_H */
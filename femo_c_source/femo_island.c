@@ -0,0 +1,474 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Island model.
+
+  Island k writes its migrants to '<dir>/island<k>'. The file is
+  written under a temporary name and renamed, so a reader sees either
+  the previous or the new set of migrants. Its first line holds the
+  island and a sequence number, a neighbour only imports a file whose
+  sequence number differs from the one it imported last. The
+  sequence continues from the own file after a restart, otherwise a
+  neighbour could take the next export for the one it has seen.
+
+  Migrants get consecutive identities in the migrant channel and are
+  inserted with update_archive(), so equal and dominated migrants are
+  rejected and the members they dominate are removed as usual. A
+  migrant that would remove the last member of one of the own
+  variators is dropped before, the variator would have no parents
+  left and be stopped.
+
+  C file.
+
+  file: femo_island.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_trace.h"
+#include "femo_island.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int island_enabled = 0; /* 1 after island_init() */
+
+/* only used in this file */
+
+#define ISLAND_NAME_LENGTH (FILE_NAME_LENGTH + 32)
+
+static char exchange_dir[FILE_NAME_LENGTH]; /* exchange directory */
+
+static int own_island = 0; /* number of this island */
+
+static int island_total = 0; /* number of islands */
+
+static int island_interval = 0; /* generations between migrations */
+
+static int island_size = 0; /* maximal number of migrants exported */
+
+static int island_topology = ISLAND_RING;
+
+static int migrant_channel = -1; /* channel of the imported migrants */
+
+static int next_migrant = 0; /* identity of the next migrant in its channel */
+
+static int sequence = 0; /* number of exports so far */
+
+static int *last_sequence = NULL; /* sequence imported last per island */
+
+/* buffers kept for the run, see island_reserve() */
+
+static int *member_ids = NULL; /* members from the own variators */
+
+static int member_ids_size = 0;
+
+static int *alive = NULL; /* members left per channel */
+
+static int alive_size = 0;
+
+static int *hits = NULL; /* members a migrant dominates per channel */
+
+static int hits_size = 0;
+
+static int *migrant_ids = NULL; /* identities of the imported migrants */
+
+static int migrant_ids_size = 0;
+
+static double *migrant_values = NULL; /* their objective values */
+
+static int migrant_values_size = 0;
+
+/*-------------------------| helper functions |-------------------------*/
+
+static int grow_values(int count)
+/* Makes 'migrant_values' hold 'count' values, at least doubling it.
+   Returns 0 if successful and 1 if out of memory. */
+{
+     double *tmp;
+     int new_size;
+
+     if (count <= migrant_values_size)
+          return (0);
+     new_size = 2 * migrant_values_size > count ? 2 * migrant_values_size
+          : count;
+     tmp = (double *) realloc(migrant_values, new_size * sizeof(double));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     migrant_values = tmp;
+     migrant_values_size = new_size;
+     return (0);
+}
+
+
+static int vector_dominates_member(double *values, int identity)
+/* Same test as dominates(), with the migrant rounded like a stored
+   value. */
+{
+     int k;
+     int a_is_worse = 0;
+     int differs = 0;
+     double a, b;
+
+     for (k = 0; k < dimension; k++)
+     {
+          a = (objective_t) values[k];
+          b = get_objective_value(identity, k);
+          a_is_worse |= a > b;
+          differs |= a != b;
+     }
+     return (differs && !a_is_worse);
+}
+
+
+static int spare_own_members(int count, double *values)
+/* Drops the migrants that would remove, together with the ones kept
+   before them, the last member of a variator. The migrants kept are
+   moved to the front of 'values'. Returns their number, -1 if out of
+   memory. */
+{
+     int *ids;
+     int i, j, n, kept, channel, orphans;
+
+     if (grow_ints(&member_ids, &member_ids_size, get_size()) != 0
+         || grow_ints(&alive, &alive_size, channel_count) != 0
+         || grow_ints(&hits, &hits_size, channel_count) != 0)
+          return (-1);
+     ids = member_ids;
+     for (i = 0; i < channel_count; i++)
+          alive[i] = 0;
+     n = 0;
+     for (i = get_first(); i != -1; i = get_next(i))
+     {
+          if (get_owner(i) != migrant_channel)
+          {
+               ids[n++] = i;
+               alive[get_owner(i)]++;
+          }
+     }
+
+     kept = 0;
+     for (j = 0; j < count; j++)
+     {
+          for (i = 0; i < channel_count; i++)
+               hits[i] = 0;
+          for (i = 0; i < n; i++)
+          {
+               if (ids[i] != -1
+                   && vector_dominates_member(&values[j * dimension], ids[i]))
+                    hits[get_owner(ids[i])]++;
+          }
+          orphans = 0;
+          for (i = 0; i < channel_count; i++)
+               orphans |= alive[i] > 0 && hits[i] == alive[i];
+          if (orphans)
+               continue;
+
+          /* kept: the members it dominates will be removed */
+          for (i = 0; i < n; i++)
+          {
+               if (ids[i] != -1
+                   && vector_dominates_member(&values[j * dimension], ids[i]))
+               {
+                    channel = get_owner(ids[i]);
+                    alive[channel]--;
+                    ids[i] = -1;
+               }
+          }
+          if (kept != j)
+               memmove(&values[kept * dimension], &values[j * dimension],
+                       dimension * sizeof(double));
+          kept++;
+     }
+     return (kept);
+}
+
+
+static int export_migrants(void)
+/* Writes a uniform sample of the members that came from the own
+   variators to the file of this island. */
+{
+     FILE *fp;
+     int *ids;
+     int count, i, j, k, tmp;
+     char name[ISLAND_NAME_LENGTH];
+     char temp_name[ISLAND_NAME_LENGTH + 4];
+
+     if (grow_ints(&member_ids, &member_ids_size, get_size()) != 0)
+          return (1);
+     ids = member_ids;
+     count = 0;
+     i = get_first();
+     while (i != -1)
+     {
+          if (get_owner(i) != migrant_channel)
+               ids[count++] = i;
+          i = get_next(i);
+     }
+
+     /* partial Fisher-Yates shuffle, the first ones are the sample */
+     if (count > island_size)
+     {
+          for (i = 0; i < island_size; i++)
+          {
+               j = i + irand(count - i);
+               tmp = ids[i];
+               ids[i] = ids[j];
+               ids[j] = tmp;
+          }
+          count = island_size;
+     }
+
+     sprintf(name, "%s/island%d", exchange_dir, own_island);
+     sprintf(temp_name, "%s.tmp", name);
+     fp = fopen(temp_name, "w");
+     if (fp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't write migrant file");
+          return (1);
+     }
+     sequence++;
+     fprintf(fp, "%d %d\n%d\n", own_island, sequence, count * dimension);
+     for (i = 0; i < count; i++)
+     {
+          for (k = 0; k < dimension; k++)
+               fprintf(fp, "%.17g ", get_objective_value(ids[i], k));
+          fprintf(fp, "\n");
+     }
+     fprintf(fp, "END");
+     fclose(fp);
+
+#ifdef PISA_WIN
+     remove(name); /* rename() doesn't replace files on Windows */
+#endif
+     if (rename(temp_name, name) != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't rename migrant file");
+          return (1);
+     }
+     return (0);
+}
+
+
+static int import_migrants(int island)
+/* Inserts the migrants of 'island' into the archive if they haven't
+   been imported yet. */
+{
+     FILE *fp;
+     int i, size, count, source, number;
+     int saved_accepted;
+     int result = 0;
+     int *ids;
+     double *values;
+     char name[ISLAND_NAME_LENGTH];
+     char tag[4];
+
+     sprintf(name, "%s/island%d", exchange_dir, island);
+     fp = fopen(name, "r");
+     if (fp == NULL)
+          return (0); /* nothing exported yet */
+     if (fscanf(fp, "%d %d %d", &source, &number, &size) != 3
+         || source != island || size < 0 || size % dimension != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "migrant file is invalid");
+          fclose(fp);
+          return (1);
+     }
+     if (number == last_sequence[island])
+     {
+          fclose(fp);
+          return (0);
+     }
+
+     count = size / dimension;
+     if (grow_ints(&migrant_ids, &migrant_ids_size, count) != 0
+         || grow_values(size) != 0)
+     {
+          fclose(fp);
+          return (1);
+     }
+     ids = migrant_ids;
+     values = migrant_values;
+     for (i = 0; i < size; i++)
+     {
+          if (fscanf(fp, "%le", &values[i]) != 1)
+               break;
+     }
+     if (i < size || fscanf(fp, "%3s", tag) != 1 || strcmp(tag, "END") != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "migrant file is invalid");
+          fclose(fp);
+          return (1);
+     }
+     fclose(fp);
+     last_sequence[island] = number;
+
+     count = spare_own_members(count, values);
+     if (count == -1)
+          return (1);
+     for (i = 0; i < count; i++)
+     {
+          ids[i] = get_identity(migrant_channel, next_migrant++);
+          if (ids[i] == -1 || add_individual(ids[i], &values[i * dimension]) != 0)
+          {
+               /* the ones added so far are still inserted */
+               result = 1;
+               count = i;
+               break;
+          }
+     }
+
+     /* 'accepted' counts the offspring of the variators only */
+     saved_accepted = accepted;
+     if (update_archive(count, ids, dimension) != 0)
+          result = 1;
+     accepted = saved_accepted;
+     return (result);
+}
+
+/*-------------------------| island functions |-------------------------*/
+
+int island_init(char *dir, int id, int count, int interval, int size,
+                int topology)
+/* Sets up the island and reserves the migrant channel. */
+{
+     int i, source, number;
+     FILE *fp;
+     char name[ISLAND_NAME_LENGTH];
+
+     island_free();
+     if (migrant_channel == -1)
+     {
+          /* identities can't be remapped later, so the channel is
+             kept across resets */
+          migrant_channel = reserve_channel();
+          if (migrant_channel == -1)
+               return (1);
+     }
+
+     last_sequence = (int *) malloc(count * sizeof(int));
+     if (last_sequence == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     for (i = 0; i < count; i++)
+          last_sequence[i] = 0;
+
+     strcpy(exchange_dir, dir);
+     own_island = id;
+     island_total = count;
+     island_interval = interval;
+     island_size = size;
+     island_topology = topology;
+
+     /* continue the sequence of an earlier run of this island */
+     sequence = 0;
+     sprintf(name, "%s/island%d", exchange_dir, own_island);
+     fp = fopen(name, "r");
+     if (fp != NULL)
+     {
+          if (fscanf(fp, "%d %d", &source, &number) == 2 && source == id)
+               sequence = number;
+          fclose(fp);
+     }
+     island_enabled = 1;
+     return (0);
+}
+
+
+int island_migrants(void)
+/* All neighbours are assumed to export up to 'island_size' members. */
+{
+     if (!island_enabled)
+          return (0);
+     if (island_topology == ISLAND_RING)
+          return (island_total > 1 ? island_size : 0);
+     return ((island_total - 1) * island_size);
+}
+
+
+int island_reserve(int count)
+/* Sizes the buffers for 'count' members and the migrants of one
+   generation. */
+{
+     if (!island_enabled)
+          return (0);
+     if (grow_ints(&member_ids, &member_ids_size, count) != 0
+         || grow_ints(&alive, &alive_size, channel_count) != 0
+         || grow_ints(&hits, &hits_size, channel_count) != 0
+         || grow_ints(&migrant_ids, &migrant_ids_size,
+                      island_migrants()) != 0
+         || grow_values(island_migrants() * dimension) != 0)
+          return (1);
+     return (0);
+}
+
+
+int island_migrate(void)
+/* Exchanges migrants in every 'island_interval'-th generation. */
+{
+     int i, result;
+     double span_begin;
+
+     if (!island_enabled || generation == 0
+         || generation % island_interval != 0)
+          return (0);
+
+     span_begin = trace_begin();
+     result = export_migrants();
+     for (i = 0; i < island_total && result == 0; i++)
+     {
+          if (i == own_island)
+               continue;
+          if (island_topology == ISLAND_RING
+              && i != (own_island + island_total - 1) % island_total)
+               continue;
+          result = import_migrants(i);
+     }
+     trace_end("migrate", "select", span_begin);
+     return (result);
+}
+
+
+void island_free(void)
+/* Frees all memory. */
+{
+     free(last_sequence);
+     free(member_ids);
+     free(alive);
+     free(hits);
+     free(migrant_ids);
+     free(migrant_values);
+     last_sequence = NULL;
+     member_ids = NULL;
+     alive = NULL;
+     hits = NULL;
+     migrant_ids = NULL;
+     migrant_values = NULL;
+     member_ids_size = 0;
+     alive_size = 0;
+     hits_size = 0;
+     migrant_ids_size = 0;
+     migrant_values_size = 0;
+     island_enabled = 0;
+}
@@ -0,0 +1,66 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Island model: several FEMO processes, each with its own archive,
+  periodically exchange a sample of their archive members through
+  files in a common directory.
+
+  Only objective vectors migrate, the decision variables stay with the
+  variator that created an individual. Migrants are therefore kept in
+  a channel of their own (see reserve_channel()): they take part in
+  the dominance update like any other member, but they are never
+  chosen as parents and never written to the 'arc' file.
+
+  Header file.
+
+  file: femo_island.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_ISLAND_H
+#define FEMO_ISLAND_H
+
+/* topologies */
+#define ISLAND_RING 0 /* import from the previous island only */
+#define ISLAND_ALL 1  /* import from all other islands */
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int island_enabled; /* 1 after island_init() */
+
+/*-------------------------| functions |--------------------------------*/
+
+int island_init(char *dir, int id, int count, int interval, int size,
+                int topology);
+/* Sets up island 'id' of 'count' islands exchanging files in 'dir'.
+   Every 'interval' generations up to 'size' members are exported and
+   the migrants of the neighbours given by 'topology' are imported.
+   Returns 0 if successful and 1 otherwise. */
+
+int island_migrants(void);
+/* Returns the largest number of migrants imported in one generation,
+   assuming every island exports up to the 'size' of this one. */
+
+int island_reserve(int count);
+/* Makes the buffers of the migration hold 'count' members and the
+   migrants of one generation, so that a migration allocates nothing
+   below it. Returns 0 if successful and 1 if out of memory. */
+
+int island_migrate(void);
+/* Exports and imports migrants if the current generation is a
+   migration generation. Called after the archive update of a
+   selection. Returns 0 if successful and 1 otherwise. */
+
+void island_free(void);
+/* Frees all memory, the island mode is switched off. */
+
+#endif /* FEMO_ISLAND_H */
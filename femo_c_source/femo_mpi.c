@@ -0,0 +1,919 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Archive partitioned across MPI ranks.
+
+  Every command of rank 0 starts with a broadcast of three ints
+  (command and two arguments), the other ranks wait for it in
+  serve(). The work of a command is done by the same do_*() function
+  on all ranks, rank 0 included. A rank that runs out of memory
+  aborts the whole job, the parts can't be kept consistent then.
+
+  Rank 0 frees the objective values of an individual once it is a
+  member, its part keeps a copy if rank 0 owns it; the owner of an
+  identity is computed by owner_of(), not stored.
+
+  C file.
+
+  file: femo_mpi.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_trace.h"
+#include "femo_query.h"
+#include "femo_duplicates.h"
+#include "femo_mpi.h"
+
+#ifdef FEMO_MPI
+#include <mpi.h>
+#endif
+
+/*--------------------| global variable definitions |-------------------*/
+
+int mpi_ranks = 1; /* number of ranks, 1 without MPI */
+
+int mpi_active = 0; /* 1 while the 'mpi' backend holds the archive */
+
+#ifdef FEMO_MPI
+
+/* only used in this file */
+
+#define COMMAND_INIT 1    /* dimension */
+#define COMMAND_BATCH 2   /* count; identities and values follow */
+#define COMMAND_ADOPT 3   /* identity, counter; values sent to the owner */
+#define COMMAND_REMOVE 4  /* identity */
+#define COMMAND_QUERY 5   /* values follow */
+#define COMMAND_CHOOSE 6  /* channel, channel count */
+#define COMMAND_CLEAR 7
+#define COMMAND_RELEASE 8
+#define COMMAND_EXIT 9
+#define COMMAND_COLLECT 10
+
+#define TAG_VALUES 1
+#define TAG_CHOSEN 2
+
+static int rank = 0;
+
+static int finished = 0; /* 1 after MPI_Finalize() on rank 0 */
+
+static int resolving = 0; /* 1 while rank 0 removes the individuals of a
+                             batch, the ranks have removed them already */
+
+static int part_dimension = 0;
+
+static int part_size = 0; /* members of this rank */
+
+static int part_capacity = 0;
+
+static int *part_identity = NULL;
+
+static int *part_counter = NULL;
+
+static double *part_values = NULL; /* part_dimension per member */
+
+static int *position = NULL; /* index in the part of each identity, -1 */
+
+static int position_size = 0;
+
+static int *batch_identity = NULL; /* batch being inserted */
+
+static double *batch_values = NULL;
+
+static int *flags = NULL; /* 1 if a new individual is dominated */
+
+static int *flags_all = NULL; /* flags of all ranks */
+
+static int batch_capacity = 0;
+
+static int *removed = NULL; /* members of this rank removed by a batch */
+
+static int removed_size = 0;
+
+static int *gathered = NULL; /* rank 0: members removed on all ranks */
+
+static int gathered_size = 0;
+
+static int *counts = NULL; /* rank 0: removed members per rank */
+
+static int *displacements = NULL;
+
+static int *lowest = NULL; /* rank 0: lowest counter and members with
+                             it, per rank */
+
+static double *vector = NULL; /* values of a query or an adopted member */
+
+static int vector_size = 0;
+
+/*-------------------------| helper functions |-------------------------*/
+
+static void fail(int line)
+/* The ranks can't go on apart. */
+{
+     log_to_file(log_file, __FILE__, line, "selector out of memory");
+     MPI_Abort(MPI_COMM_WORLD, 1);
+}
+
+
+static void *grow(void *buffer, size_t size)
+{
+     void *tmp;
+
+     tmp = realloc(buffer, size > 0 ? size : 1);
+     if (tmp == NULL)
+          fail(__LINE__);
+     return (tmp);
+}
+
+
+static void reserve_vector(void)
+{
+     if (vector_size < part_dimension)
+     {
+          vector = (double *) grow(vector, part_dimension * sizeof(double));
+          vector_size = part_dimension;
+     }
+}
+
+
+static void reserve_batch(int count)
+{
+     if (count <= batch_capacity)
+          return;
+     batch_identity = (int *) grow(batch_identity, count * sizeof(int));
+     batch_values = (double *) grow(batch_values, (size_t) count
+                                    * part_dimension * sizeof(double));
+     flags = (int *) grow(flags, count * sizeof(int));
+     flags_all = (int *) grow(flags_all, count * sizeof(int));
+     batch_capacity = count;
+}
+
+
+static void send_command(int command, int a, int b)
+{
+     int header[3];
+
+     header[0] = command;
+     header[1] = a;
+     header[2] = b;
+     MPI_Bcast(header, 3, MPI_INT, 0, MPI_COMM_WORLD);
+}
+
+
+static int owner_of(int identity)
+/* Multiplicative hash, so that the channels (identity modulo the
+   channel count) are spread over all ranks. */
+{
+     return ((int) (((unsigned int) identity * 2654435761u) >> 16)
+             % mpi_ranks);
+}
+
+
+static int vector_dominates(double *a, double *b)
+/* Same test as dominates(). */
+{
+     int i;
+     int a_is_worse = 0;
+     int differs = 0;
+
+     for (i = 0; i < part_dimension; i++)
+     {
+          a_is_worse |= a[i] > b[i];
+          differs |= a[i] != b[i];
+     }
+     return (differs && !a_is_worse);
+}
+
+
+static int vector_covers(double *a, double *b)
+/* Returns 1 if 'a' dominates 'b' or is equal to it, either rejects a
+   new 'b'. */
+{
+     int i;
+     int a_is_worse = 0;
+
+     for (i = 0; i < part_dimension; i++)
+          a_is_worse |= a[i] > b[i];
+     return (!a_is_worse);
+}
+
+
+static int compare_ints(const void *a, const void *b)
+{
+     int x = *(const int *) a;
+     int y = *(const int *) b;
+
+     return (x < y ? -1 : x > y);
+}
+
+
+static void drop_values(int identity)
+/* Rank 0 forgets the objective values of a member, they are kept by
+   its owner. */
+{
+     individual *ind;
+
+     ind = get_individual(identity);
+     free(ind->objective_value);
+     ind->objective_value = NULL;
+}
+
+/*-------------------------| part functions |---------------------------*/
+
+static void part_add(int identity, int counter, double *values)
+{
+     int i, old_size;
+
+     if (part_size == part_capacity)
+     {
+          part_capacity = part_capacity == 0 ? 64 : 2 * part_capacity;
+          part_identity = (int *) grow(part_identity,
+                                       part_capacity * sizeof(int));
+          part_counter = (int *) grow(part_counter,
+                                      part_capacity * sizeof(int));
+          part_values = (double *) grow(part_values, (size_t) part_capacity
+                                        * part_dimension * sizeof(double));
+     }
+     if (identity >= position_size)
+     {
+          old_size = position_size;
+          if (grow_ints(&position, &position_size, identity + 1) != 0)
+               fail(__LINE__);
+          for (i = old_size; i < position_size; i++)
+               position[i] = -1;
+     }
+     position[identity] = part_size;
+     part_identity[part_size] = identity;
+     part_counter[part_size] = counter;
+     memcpy(&part_values[(size_t) part_size * part_dimension], values,
+            part_dimension * sizeof(double));
+     part_size++;
+}
+
+
+static void part_remove(int identity)
+/* The last member takes the place of the removed one. */
+{
+     int i, last;
+
+     if (identity >= position_size || position[identity] == -1)
+          return;
+     i = position[identity];
+     last = --part_size;
+     if (i != last)
+     {
+          part_identity[i] = part_identity[last];
+          part_counter[i] = part_counter[last];
+          memcpy(&part_values[(size_t) i * part_dimension],
+                 &part_values[(size_t) last * part_dimension],
+                 part_dimension * sizeof(double));
+          position[part_identity[i]] = i;
+     }
+     position[identity] = -1;
+}
+
+
+static void part_clear(void)
+{
+     int i;
+
+     for (i = 0; i < part_size; i++)
+          position[part_identity[i]] = -1;
+     part_size = 0;
+}
+
+
+static void part_free(void)
+{
+     free(part_identity);
+     free(part_counter);
+     free(part_values);
+     free(position);
+     free(batch_identity);
+     free(batch_values);
+     free(flags);
+     free(flags_all);
+     free(removed);
+     free(gathered);
+     free(counts);
+     free(displacements);
+     free(lowest);
+     free(vector);
+     part_identity = NULL;
+     part_counter = NULL;
+     part_values = NULL;
+     position = NULL;
+     batch_identity = NULL;
+     batch_values = NULL;
+     flags = NULL;
+     flags_all = NULL;
+     removed = NULL;
+     gathered = NULL;
+     counts = NULL;
+     displacements = NULL;
+     lowest = NULL;
+     vector = NULL;
+     part_size = 0;
+     part_capacity = 0;
+     position_size = 0;
+     batch_capacity = 0;
+     removed_size = 0;
+     gathered_size = 0;
+     vector_size = 0;
+}
+
+/*-------------------------| commands |---------------------------------*/
+
+static void do_init(int dim)
+{
+     part_free();
+     part_dimension = dim;
+}
+
+
+static int do_batch(int count)
+/* Tests the batch against the part and the share of this rank of the
+   batch against the rest of it. A new individual equal to a member or
+   to an earlier new one is rejected like a dominated one, in place of
+   the duplicate set of rank 0. Returns the number of members removed
+   on all ranks (rank 0 only), their identities are in 'gathered' and
+   the rejected new individuals flagged in 'flags_all'. */
+{
+     int i, j, m, count_removed, total;
+     double *member, *values, *other;
+
+     MPI_Bcast(batch_identity, count, MPI_INT, 0, MPI_COMM_WORLD);
+     MPI_Bcast(batch_values, count * part_dimension, MPI_DOUBLE, 0,
+               MPI_COMM_WORLD);
+     for (i = 0; i < count; i++)
+          flags[i] = 0;
+
+     count_removed = 0;
+     for (m = 0; m < part_size; m++)
+     {
+          member = &part_values[(size_t) m * part_dimension];
+          for (i = 0; i < count; i++)
+          {
+               values = &batch_values[(size_t) i * part_dimension];
+               if (vector_dominates(values, member))
+                    break;
+               if (!flags[i] && vector_covers(member, values))
+                    flags[i] = 1;
+          }
+          if (i < count)
+          {
+               if (grow_ints(&removed, &removed_size, count_removed + 1) != 0)
+                    fail(__LINE__);
+               removed[count_removed++] = part_identity[m];
+          }
+     }
+     for (i = 0; i < count_removed; i++)
+          part_remove(removed[i]);
+
+     for (i = rank; i < count; i += mpi_ranks)
+     {
+          values = &batch_values[(size_t) i * part_dimension];
+          for (j = 0; j < count && !flags[i]; j++)
+          {
+               other = &batch_values[(size_t) j * part_dimension];
+               if (j < i ? vector_covers(other, values)
+                   : j > i && vector_dominates(other, values))
+                    flags[i] = 1;
+          }
+     }
+
+     MPI_Allreduce(flags, flags_all, count, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+     for (i = 0; i < count; i++)
+     {
+          if (!flags_all[i] && owner_of(batch_identity[i]) == rank)
+               part_add(batch_identity[i], 0,
+                        &batch_values[(size_t) i * part_dimension]);
+     }
+
+     if (rank == 0)
+     {
+          counts = (int *) grow(counts, mpi_ranks * sizeof(int));
+          displacements = (int *) grow(displacements, mpi_ranks * sizeof(int));
+     }
+     MPI_Gather(&count_removed, 1, MPI_INT, counts, 1, MPI_INT, 0,
+                MPI_COMM_WORLD);
+     total = 0;
+     if (rank == 0)
+     {
+          for (i = 0; i < mpi_ranks; i++)
+          {
+               displacements[i] = total;
+               total += counts[i];
+          }
+          if (grow_ints(&gathered, &gathered_size, total) != 0)
+               fail(__LINE__);
+     }
+     MPI_Gatherv(removed, count_removed, MPI_INT, gathered, counts,
+                 displacements, MPI_INT, 0, MPI_COMM_WORLD);
+     return (total);
+}
+
+
+static void do_adopt(int identity, int counter)
+{
+     int owner;
+
+     owner = owner_of(identity);
+     if (rank == 0 && owner != 0)
+          MPI_Send(vector, part_dimension, MPI_DOUBLE, owner, TAG_VALUES,
+                   MPI_COMM_WORLD);
+     if (rank != owner)
+          return;
+     reserve_vector();
+     if (rank != 0)
+          MPI_Recv(vector, part_dimension, MPI_DOUBLE, 0, TAG_VALUES,
+                   MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+     part_add(identity, counter, vector);
+}
+
+
+static void do_query(int *result)
+/* Counts equal members, members dominating the vector and members it
+   dominates. The sums are in 'result' on rank 0. */
+{
+     int i, m;
+     int a_is_worse, b_is_worse, differs;
+     int local[3];
+     double *member;
+
+     reserve_vector();
+     MPI_Bcast(vector, part_dimension, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+     local[0] = 0;
+     local[1] = 0;
+     local[2] = 0;
+     for (m = 0; m < part_size; m++)
+     {
+          member = &part_values[(size_t) m * part_dimension];
+          a_is_worse = 0;
+          b_is_worse = 0;
+          differs = 0;
+          for (i = 0; i < part_dimension; i++)
+          {
+               a_is_worse |= vector[i] > member[i];
+               b_is_worse |= member[i] > vector[i];
+               differs |= vector[i] != member[i];
+          }
+          if (!differs)
+               local[0]++;
+          else if (!a_is_worse)
+               local[2]++;
+          else if (!b_is_worse)
+               local[1]++;
+     }
+     MPI_Reduce(local, result, 3, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+}
+
+
+static int do_choose(int channel, int channels)
+/* Every rank reports its lowest counter and the number of members
+   with it in one gather, rank 0 picks one of the members with the
+   lowest counter of all and its owner sends the identity. Returns the
+   member chosen (on rank 0), -1 if there is none. */
+{
+     int m, r, k, id, total, least;
+     int local[2], pick[2];
+
+     local[0] = INT_MAX;
+     local[1] = 0;
+     for (m = 0; m < part_size; m++)
+     {
+          if (channels > 1 && part_identity[m] % channels != channel)
+               continue;
+          if (part_counter[m] < local[0])
+          {
+               local[0] = part_counter[m];
+               local[1] = 1;
+          }
+          else if (part_counter[m] == local[0])
+               local[1]++;
+     }
+     if (rank == 0)
+          lowest = (int *) grow(lowest, 2 * mpi_ranks * sizeof(int));
+     MPI_Gather(local, 2, MPI_INT, lowest, 2, MPI_INT, 0, MPI_COMM_WORLD);
+
+     /* pick[0]: rank, pick[1]: number of the member among its ties */
+     if (rank == 0)
+     {
+          least = INT_MAX;
+          total = 0;
+          for (r = 0; r < mpi_ranks; r++)
+               if (lowest[2 * r] < least)
+                    least = lowest[2 * r];
+          for (r = 0; r < mpi_ranks; r++)
+               if (lowest[2 * r] == least)
+                    total += lowest[2 * r + 1];
+          pick[0] = -1;
+          if (least != INT_MAX)
+          {
+               k = irand(total);
+               for (r = 0; lowest[2 * r] != least || k >= lowest[2 * r + 1];
+                    r++)
+                    if (lowest[2 * r] == least)
+                         k -= lowest[2 * r + 1];
+               pick[0] = r;
+               pick[1] = k;
+          }
+     }
+     MPI_Bcast(pick, 2, MPI_INT, 0, MPI_COMM_WORLD);
+     if (pick[0] == -1)
+          return (-1);
+
+     id = -1;
+     if (rank == pick[0])
+     {
+          k = pick[1];
+          for (m = 0; m < part_size; m++)
+          {
+               if ((channels <= 1 || part_identity[m] % channels == channel)
+                   && part_counter[m] == local[0] && k-- == 0)
+               {
+                    id = part_identity[m];
+                    part_counter[m]++;
+                    break;
+               }
+          }
+          if (rank != 0)
+               MPI_Send(&id, 1, MPI_INT, 0, TAG_CHOSEN, MPI_COMM_WORLD);
+     }
+     else if (rank == 0)
+          MPI_Recv(&id, 1, MPI_INT, pick[0], TAG_CHOSEN, MPI_COMM_WORLD,
+                   MPI_STATUS_IGNORE);
+     return (id);
+}
+
+
+static void do_collect(void)
+/* Sends the members of the part with their objective values to rank
+   0, which puts the values back into the individuals and the
+   duplicate set, then frees the part. */
+{
+     int i, k, total, equal;
+     double *values;
+     objective_t *obj_value;
+     individual *ind;
+
+     if (rank == 0)
+     {
+          counts = (int *) grow(counts, mpi_ranks * sizeof(int));
+          displacements = (int *) grow(displacements, mpi_ranks * sizeof(int));
+     }
+     MPI_Gather(&part_size, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+     total = 0;
+     if (rank == 0)
+     {
+          for (i = 0; i < mpi_ranks; i++)
+          {
+               displacements[i] = total;
+               total += counts[i];
+          }
+          if (grow_ints(&gathered, &gathered_size, total) != 0)
+               fail(__LINE__);
+     }
+     MPI_Gatherv(part_identity, part_size, MPI_INT, gathered, counts,
+                 displacements, MPI_INT, 0, MPI_COMM_WORLD);
+     values = NULL;
+     if (rank == 0)
+     {
+          for (i = 0; i < mpi_ranks; i++)
+          {
+               counts[i] *= part_dimension;
+               displacements[i] *= part_dimension;
+          }
+          values = (double *) grow(NULL, (size_t) total * part_dimension
+                                   * sizeof(double));
+     }
+     MPI_Gatherv(part_values, part_size * part_dimension, MPI_DOUBLE,
+                 values, counts, displacements, MPI_DOUBLE, 0,
+                 MPI_COMM_WORLD);
+
+     if (rank == 0)
+     {
+          duplicates_enabled = 1;
+          for (i = 0; i < total; i++)
+          {
+               ind = get_individual(gathered[i]);
+               obj_value = (objective_t *) grow(NULL, part_dimension
+                                                * sizeof(objective_t));
+               for (k = 0; k < part_dimension; k++)
+                    obj_value[k] = (objective_t) values[(size_t) i
+                                                        * part_dimension + k];
+               ind->objective_value = obj_value;
+               if (duplicate_insert(gathered[i], &equal) != 0)
+                    fail(__LINE__);
+          }
+          free(values);
+     }
+     part_free();
+}
+
+
+static int serve(void)
+/* Command loop of the ranks other than 0. */
+{
+     int header[3];
+     int result[3];
+
+     while (1)
+     {
+          MPI_Bcast(header, 3, MPI_INT, 0, MPI_COMM_WORLD);
+          switch (header[0])
+          {
+          case COMMAND_INIT:
+               do_init(header[1]);
+               break;
+          case COMMAND_BATCH:
+               reserve_batch(header[1]);
+               do_batch(header[1]);
+               break;
+          case COMMAND_ADOPT:
+               do_adopt(header[1], header[2]);
+               break;
+          case COMMAND_REMOVE:
+               if (owner_of(header[1]) == rank)
+                    part_remove(header[1]);
+               break;
+          case COMMAND_QUERY:
+               do_query(result);
+               break;
+          case COMMAND_CHOOSE:
+               do_choose(header[1], header[2]);
+               break;
+          case COMMAND_CLEAR:
+               part_clear();
+               break;
+          case COMMAND_RELEASE:
+               part_free();
+               break;
+          case COMMAND_COLLECT:
+               do_collect();
+               break;
+          case COMMAND_EXIT:
+               part_free();
+               return (0);
+          default:
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "unknown command from rank 0");
+               return (1);
+          }
+     }
+}
+
+
+static void finish(void)
+/* atexit() handler of rank 0: ends the other ranks. */
+{
+     if (finished)
+          return;
+     finished = 1;
+     send_command(COMMAND_EXIT, 0, 0);
+     part_free();
+     MPI_Finalize();
+}
+
+/*-------------------------| mpi functions |----------------------------*/
+
+int mpi_start(int *argc, char ***argv)
+{
+     int result;
+
+     MPI_Init(argc, argv);
+     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+     MPI_Comm_size(MPI_COMM_WORLD, &mpi_ranks);
+     if (rank == 0)
+     {
+          atexit(finish);
+          return (-1);
+     }
+     result = serve();
+     MPI_Finalize();
+     return (result);
+}
+
+
+int mpi_init(void)
+{
+     send_command(COMMAND_INIT, dimension, 0);
+     do_init(dimension);
+     duplicate_clear();
+     duplicates_enabled = 0;
+     mpi_active = 1;
+     return (0);
+}
+
+
+int mpi_insert_batch(int size, int *new_identity)
+/* Members removed first, in the order of their identities, then the
+   dominated new individuals from the last one, as 'linear' does. */
+{
+     int i, k, count, total;
+     individual *ind;
+     double span_begin;
+
+     span_begin = trace_begin();
+     reserve_batch(size);
+     count = 0;
+     for (i = 0; i < size; i++)
+     {
+          ind = get_individual(new_identity[i]);
+          if (ind == NULL)
+               continue; /* equal to another one */
+          batch_identity[count] = new_identity[i];
+          for (k = 0; k < part_dimension; k++)
+               batch_values[(size_t) count * part_dimension + k] =
+                    ind->objective_value[k];
+          count++;
+     }
+     send_command(COMMAND_BATCH, count, 0);
+     total = do_batch(count);
+
+     if (total > 0)
+          qsort(gathered, total, sizeof(int), compare_ints);
+     resolving = 1;
+     for (i = 0; i < total; i++)
+     {
+          if (femo_remove(gathered[i]) != 0)
+          {
+               resolving = 0;
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "removing individual failed");
+               return (1);
+          }
+     }
+     for (i = count - 1; i >= 0; i--)
+     {
+          if (flags_all[i] && femo_remove(batch_identity[i]) != 0)
+          {
+               resolving = 0;
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "removing individual failed");
+               return (1);
+          }
+     }
+     resolving = 0;
+     for (i = 0; i < count; i++)
+          if (get_individual(batch_identity[i]) != NULL)
+               drop_values(batch_identity[i]);
+     trace_end("mpi_insert", "select", span_begin);
+     return (0);
+}
+
+
+int mpi_adopt(int identity)
+{
+     int k;
+     individual *ind;
+
+     ind = get_individual(identity);
+     reserve_vector();
+     for (k = 0; k < part_dimension; k++)
+          vector[k] = ind->objective_value[k];
+     send_command(COMMAND_ADOPT, identity, ind->counter);
+     do_adopt(identity, ind->counter);
+     drop_values(identity);
+     return (0);
+}
+
+
+int mpi_query(double *objective_value, int *removed_count)
+{
+     int result[3];
+
+     reserve_vector();
+     memcpy(vector, objective_value, part_dimension * sizeof(double));
+     send_command(COMMAND_QUERY, 0, 0);
+     do_query(result);
+     *removed_count = 0;
+     if (result[0] > 0)
+          return (QUERY_EQUAL);
+     if (result[1] > 0)
+          return (QUERY_DOMINATED);
+     *removed_count = result[2];
+     return (QUERY_ACCEPTED);
+}
+
+
+int mpi_remove(int identity)
+{
+     if (resolving)
+          return (0);
+     send_command(COMMAND_REMOVE, identity, 0);
+     if (owner_of(identity) == 0)
+          part_remove(identity);
+     return (0);
+}
+
+
+int mpi_choose(void)
+{
+     send_command(COMMAND_CHOOSE, current_channel, channel_count);
+     return (do_choose(current_channel, channel_count));
+}
+
+
+void mpi_clear(void)
+{
+     send_command(COMMAND_CLEAR, 0, 0);
+     part_clear();
+}
+
+
+void mpi_release(void)
+{
+     send_command(COMMAND_RELEASE, 0, 0);
+     part_free();
+     duplicates_enabled = 1;
+     mpi_active = 0;
+}
+
+
+int mpi_collect(void)
+{
+     send_command(COMMAND_COLLECT, 0, 0);
+     do_collect();
+     mpi_active = 0;
+     return (0);
+}
+
+#else /* a single rank without MPI */
+
+int mpi_start(int *argc, char ***argv)
+{
+     return (-1);
+}
+
+
+int mpi_init(void)
+{
+     log_to_file(log_file, __FILE__, __LINE__,
+                 "archive_backend mpi needs femo_mpi");
+     return (1);
+}
+
+
+int mpi_insert_batch(int size, int *new_identity)
+{
+     return (1);
+}
+
+
+int mpi_adopt(int identity)
+{
+     return (1);
+}
+
+
+int mpi_query(double *objective_value, int *removed)
+{
+     *removed = 0;
+     return (QUERY_ACCEPTED);
+}
+
+
+int mpi_remove(int identity)
+{
+     return (0);
+}
+
+
+int mpi_choose(void)
+{
+     return (-1);
+}
+
+
+void mpi_clear(void)
+{
+}
+
+
+void mpi_release(void)
+{
+}
+
+
+int mpi_collect(void)
+{
+     return (1);
+}
+
+#endif /* FEMO_MPI */
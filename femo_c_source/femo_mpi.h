@@ -0,0 +1,107 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Archive partitioned across MPI ranks ('make femo_mpi').
+
+  Started with 'mpirun -np N femo_mpi paramfile filenamebase poll',
+  rank 0 runs FEMO as usual and the other ranks wait for its
+  commands. Every rank, rank 0 included, keeps the objective values
+  and counters of a part of the archive, chosen by a hash of the
+  identity, and the 'mpi' archive backend (femo_backend.h) works on
+  the parts:
+
+    insert_batch  the batch is broadcast, each rank tests it against
+                  its part and a share of the batch against the rest
+                  of the batch and removes its dominated members; new
+                  individuals equal to a member or to an earlier one
+                  are rejected as well, the duplicate set of rank 0
+                  is not used; the flags of the new individuals are
+                  combined with an allreduce and the identities
+                  removed gathered to rank 0, which calls
+                  femo_remove() for them
+    query         the vector is broadcast and the results reduced
+    choose        one gather of the lowest counter of every rank and
+                  the number of its members with it; rank 0 picks one
+                  of all members with the lowest counter and its
+                  owner sends the identity
+    adopt/remove  sent to the rank owning the identity
+
+  Rank 0 keeps only the identities (with counters and handles) in the
+  global population, which the 'sel' and 'arc' files need; the
+  objective values of an individual are freed once it is a member.
+  So hv_reference, max_archive, archive_file, island_dir, export_file,
+  history_file and several variators, which need them, can't be used
+  with this backend.
+  The archive is the same as with 'linear'. The parents are drawn
+  uniformly among the members with the lowest counter as well, but
+  which one is drawn depends on the split into parts.
+
+  Without FEMO_MPI (plain 'make') there is a single rank and the
+  functions of the backend must not be called.
+
+  Header file.
+
+  file: femo_mpi.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_MPI_H
+#define FEMO_MPI_H
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int mpi_ranks; /* number of ranks, 1 without MPI */
+
+extern int mpi_active; /* 1 while the 'mpi' backend holds the archive,
+                          rank 0 has no objective values of members */
+
+/*-------------------------| functions |--------------------------------*/
+
+int mpi_start(int *argc, char ***argv);
+/* Initializes MPI. On rank 0 it returns -1 and FEMO goes on, the
+   other ranks serve the commands of rank 0 until it ends and return
+   the exit code of the process. Returns -1 without FEMO_MPI. */
+
+int mpi_init(void);
+/* Sets up empty parts for 'dimension' objectives on all ranks and
+   turns off the duplicate set of rank 0.
+   Returns 0 if successful and 1 otherwise. */
+
+int mpi_insert_batch(int size, int *new_identity);
+/* insert_batch() of the 'mpi' backend. */
+
+int mpi_adopt(int identity);
+/* adopt() of the 'mpi' backend, the counter is taken over. */
+
+int mpi_query(double *objective_value, int *removed);
+/* query() of the 'mpi' backend. */
+
+int mpi_remove(int identity);
+/* remove() of the 'mpi' backend. */
+
+int mpi_choose(void);
+/* choose() of the 'mpi' backend. The owner of the member chosen
+   increases its counter right away, as choose_parents() does. */
+
+void mpi_clear(void);
+/* Empties the parts of all ranks. */
+
+void mpi_release(void);
+/* Frees the parts of all ranks. */
+
+int mpi_collect(void);
+/* Gives the objective values of all members back to rank 0, adds
+   them to the duplicate set and frees the parts, the archive can be
+   handed to another backend then.
+   Returns 0 if successful and 1 otherwise. */
+
+#endif /* FEMO_MPI_H */
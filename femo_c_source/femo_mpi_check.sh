@@ -0,0 +1,56 @@
+#!/bin/sh
+# Check of femo_mpi ('make check_mpi', see femo_mpi.h).
+#
+# Runs the scenarios of 'femo_variator -record' with femo and records
+# their traces, runs them again live with femo_mpi on RANKS ranks and
+# replays every trace with femo_mpi on RANKS ranks, which compares the
+# archive of every batch with the one recorded. Fails if a run fails
+# or a replay doesn't match.
+#
+# Usage: sh femo_mpi_check.sh [RANKS]
+# MPIRUN is the command starting the ranks, e.g.
+# MPIRUN="mpirun --oversubscribe" for more ranks than cores.
+
+RANKS=${1:-4}
+MPIRUN=${MPIRUN:-mpirun}
+
+directory=`mktemp -d /tmp/femo_mpi_check_XXXXXX` || exit 1
+mkdir "$directory/traces" "$directory/live" || exit 1
+
+# femo_variator starts a single program, so the ranks are started
+# by a wrapper
+cat > "$directory/femo_np" <<END
+#!/bin/sh
+exec $MPIRUN -np $RANKS "`pwd`/femo_mpi" "\$@"
+END
+chmod +x "$directory/femo_np"
+
+failed=0
+
+echo "recording with femo"
+./femo_variator -record "$directory/traces" ./femo || failed=1
+
+echo "running on $RANKS ranks"
+./femo_variator -record "$directory/live" "$directory/femo_np" || failed=1
+
+echo "replaying on $RANKS ranks"
+for trace in "$directory"/traces/*.trace
+do
+     printf "%-12s " `basename "$trace" .trace`
+     $MPIRUN -np $RANKS ./femo_mpi -replay "$trace" > "$trace.out" 2>&1
+     if [ $? -eq 0 ]
+     then
+          echo ok
+     else
+          echo FAILED
+          failed=1
+     fi
+done
+
+if [ $failed -ne 0 ]
+then
+     echo "femo_mpi check failed, files in $directory"
+     exit 1
+fi
+echo "femo_mpi check passed, files in $directory"
+exit 0
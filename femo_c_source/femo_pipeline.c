@@ -0,0 +1,208 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Pipelined 'arc' file.
+
+  The snapshot holds the local identities, so the writer thread never
+  touches the global population. It is only refilled after the
+  writer has finished with it, one buffer is enough.
+
+  C file.
+
+  file: femo_pipeline.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_trace.h"
+#include "femo_backend.h"
+#include "femo_pipeline.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int pipeline_enabled = 0; /* 1 if the 'arc' file is written in the
+                             background */
+
+/* only used in this file */
+
+static pthread_t writer;
+
+static int writer_started = 0; /* 1 while the thread exists */
+
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_cond_t writer_changed = PTHREAD_COND_INITIALIZER;
+
+static int pending = 0; /* 1 from handing over a snapshot until it is
+                           written */
+
+static int stopping = 0; /* 1 if the thread has to end */
+
+static int failed = 0; /* 1 if writing a snapshot failed */
+
+static int *snapshot = NULL; /* local identities of the members */
+
+static int snapshot_size = 0;
+
+static int snapshot_capacity = 0;
+
+static char snapshot_file[FILE_NAME_LENGTH_INTERNAL]; /* 'arc' file */
+
+static char temp_file[FILE_NAME_LENGTH_INTERNAL + 4]; /* written first */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static int write_snapshot(void)
+/* Writes the snapshot like write_arc() and moves it into place. */
+{
+     FILE *fp;
+     int i;
+     double span_begin;
+
+     span_begin = trace_begin();
+     fp = fopen(temp_file, "w");
+     if (fp == NULL)
+          return (1);
+     fprintf(fp, "%d\n", snapshot_size);
+     for (i = 0; i < snapshot_size; i++)
+          fprintf(fp, "%d\n", snapshot[i]);
+     fprintf(fp, "END");
+     if (fclose(fp) != 0 || rename(temp_file, snapshot_file) != 0)
+          return (1);
+     trace_end("write_arc", "io", span_begin);
+     return (0);
+}
+
+
+static void *writer_main(void *argument)
+/* Writes each snapshot handed over until pipeline_free(). */
+{
+     int result;
+
+     pthread_mutex_lock(&writer_lock);
+     while (1)
+     {
+          while (!pending && !stopping)
+               pthread_cond_wait(&writer_changed, &writer_lock);
+          if (!pending)
+               break; /* stopping, nothing left to write */
+          pthread_mutex_unlock(&writer_lock);
+          result = write_snapshot();
+          pthread_mutex_lock(&writer_lock);
+          failed |= result;
+          pending = 0;
+          pthread_cond_broadcast(&writer_changed);
+     }
+     pthread_mutex_unlock(&writer_lock);
+     return (NULL);
+}
+
+/*-------------------------| pipeline functions |-----------------------*/
+
+int pipeline_arc(void)
+{
+     int i, count, identity;
+
+     if (pipeline_wait() != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't write arc file");
+          return (1);
+     }
+
+     /* the writer is idle, the snapshot can be refilled */
+     if (grow_ints(&snapshot, &snapshot_capacity, get_size()) != 0)
+          return (1);
+     count = backend->snapshot(snapshot);
+     snapshot_size = 0;
+     for (i = 0; i < count; i++)
+     {
+          identity = snapshot[i];
+          if (get_owner(identity) == current_channel)
+               snapshot[snapshot_size++] = get_local_identity(identity);
+     }
+     strcpy(snapshot_file, arc_file);
+     sprintf(temp_file, "%s.tmp", arc_file);
+
+     if (!writer_started)
+     {
+          stopping = 0;
+          if (pthread_create(&writer, NULL, writer_main, NULL) != 0)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "couldn't start arc writer");
+               return (1);
+          }
+          writer_started = 1;
+     }
+     pthread_mutex_lock(&writer_lock);
+     pending = 1;
+     pthread_cond_broadcast(&writer_changed);
+     pthread_mutex_unlock(&writer_lock);
+     return (0);
+}
+
+
+int pipeline_reserve(int count)
+{
+     if (!pipeline_enabled || count <= snapshot_capacity)
+          return (0);
+
+     /* the writer must not be reading the snapshot, a failure is
+        left for pipeline_arc() to report */
+     pthread_mutex_lock(&writer_lock);
+     while (pending)
+          pthread_cond_wait(&writer_changed, &writer_lock);
+     pthread_mutex_unlock(&writer_lock);
+     return (grow_ints(&snapshot, &snapshot_capacity, count));
+}
+
+
+int pipeline_wait(void)
+{
+     int result;
+
+     pthread_mutex_lock(&writer_lock);
+     while (pending)
+          pthread_cond_wait(&writer_changed, &writer_lock);
+     result = failed;
+     failed = 0;
+     pthread_mutex_unlock(&writer_lock);
+     return (result);
+}
+
+
+void pipeline_free(void)
+{
+     if (writer_started)
+     {
+          pthread_mutex_lock(&writer_lock);
+          stopping = 1;
+          pthread_cond_broadcast(&writer_changed);
+          pthread_mutex_unlock(&writer_lock);
+          pthread_join(writer, NULL);
+          writer_started = 0;
+     }
+     pending = 0;
+     failed = 0;
+     free(snapshot);
+     snapshot = NULL;
+     snapshot_size = 0;
+     snapshot_capacity = 0;
+}
@@ -0,0 +1,62 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Pipelined 'arc' file.
+
+  With 'pipelined_arc 1' state1() and state3() only take a snapshot of
+  the archive identities, and a writer thread writes the 'arc' file
+  from it while the variator already works on the new 'sel' file. The
+  file is written under '<arc file>.tmp' and renamed, so the 'arc'
+  file is always either the '0' left by the variator or complete.
+
+  The variator may start as soon as it sees state 2, but has to wait
+  for the 'arc' file (a count other than '0' and 'END') before it
+  writes the next 'var' file and state 3.
+
+  Header file.
+
+  file: femo_pipeline.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_PIPELINE_H
+#define FEMO_PIPELINE_H
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int pipeline_enabled; /* 1 if the 'arc' file is written in the
+                                background */
+
+/*-------------------------| functions |--------------------------------*/
+
+int pipeline_arc(void);
+/* Waits for the previous 'arc' file, takes a snapshot of the archive
+   members of the current variator and hands it to the writer thread
+   (started on first use).
+   Returns 0 if successful and 1 if this or the previous 'arc' file
+   couldn't be written. */
+
+int pipeline_reserve(int count);
+/* Makes the snapshot hold 'count' members, after the writer thread is
+   done with it. Does nothing unless pipeline_enabled.
+   Returns 0 if successful and 1 if out of memory. */
+
+int pipeline_wait(void);
+/* Waits until the writer thread has written the last snapshot. Returns
+   at once if nothing is pending.
+   Returns 0 if successful and 1 if writing failed. */
+
+void pipeline_free(void);
+/* Waits for the last snapshot, stops the writer thread and frees all
+   memory. */
+
+#endif /* FEMO_PIPELINE_H */
@@ -0,0 +1,245 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Adaptive polling.
+
+  The turnaround is measured from the first read of state 2, which
+  follows the write of state 2 by main() without a sleep in between.
+  The states of the asynchronous mode aren't learned, it waits with
+  the fixed interval.
+
+  C file.
+
+  file: femo_poll.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_trace.h"
+#include "femo_poll.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int poll_adaptive = 0; /* 1 if the polling interval adapts */
+
+double poll_max = 5.0; /* longest interval in seconds */
+
+double state_timeout = 0; /* seconds an unreadable state is tolerated,
+                             0 for ever */
+
+int state_timeout_abort = 0; /* 1 to stop after 'state_timeout' */
+
+/* only used in this file */
+
+#define POLL_MAX_DOUBLINGS 30
+
+/* what is known about one variator */
+typedef struct poll_channel_t
+{
+     int last_state; /* state read last time */
+     int working; /* 1 from the first read of state 2 until the turn
+                     comes back */
+     double since; /* start of the turn in seconds */
+     int samples; /* turnarounds measured */
+     double mean; /* smoothed turnaround in seconds */
+     double deviation; /* smoothed mean deviation */
+     int backoff; /* doublings of the interval */
+     int unreadable; /* 1 while the state can't be read */
+     double unreadable_since;
+     int reported; /* 1 if the timeout has been reported */
+} poll_channel;
+
+static poll_channel *known = NULL; /* one per channel */
+
+static int known_count = 0;
+
+/*-------------------------| helper functions |-------------------------*/
+
+static double now_seconds(void)
+{
+     return (trace_begin() * 1e-6);
+}
+
+
+static int know_channels(void)
+/* Makes room for all channels. Returns 0 if successful and 1 if out
+   of memory. */
+{
+     poll_channel *tmp;
+     int i;
+
+     if (known_count >= channel_count)
+          return (0);
+     tmp = (poll_channel *) realloc(known,
+                                    channel_count * sizeof(poll_channel));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     known = tmp;
+     for (i = known_count; i < channel_count; i++)
+     {
+          known[i].last_state = -2;
+          known[i].working = 0;
+          known[i].since = 0;
+          known[i].samples = 0;
+          known[i].mean = 0;
+          known[i].deviation = 0;
+          known[i].backoff = 0;
+          known[i].unreadable = 0;
+          known[i].unreadable_since = 0;
+          known[i].reported = 0;
+     }
+     known_count = channel_count;
+     return (0);
+}
+
+
+static void learn(poll_channel *c, double turnaround)
+/* Updates mean and deviation with a new turnaround. */
+{
+     if (c->samples == 0)
+     {
+          c->mean = turnaround;
+          c->deviation = turnaround / 2;
+     }
+     else
+     {
+          c->deviation = 0.75 * c->deviation
+               + 0.25 * fabs(turnaround - c->mean);
+          c->mean = 0.875 * c->mean + 0.125 * turnaround;
+     }
+     c->samples++;
+}
+
+
+static double doubled(double poll, int *backoff)
+/* Returns 'poll' doubled '*backoff' times and counts one more. */
+{
+     double interval;
+
+     interval = ldexp(poll, *backoff);
+     if (*backoff < POLL_MAX_DOUBLINGS)
+          (*backoff)++;
+     return (interval);
+}
+
+
+static double channel_interval(poll_channel *c, double poll, double now)
+/* Returns the interval wanted for one variator. */
+{
+     double elapsed, early, late;
+
+     if (!c->working)
+          return (doubled(poll, &c->backoff)); /* idle */
+     if (c->samples == 0)
+          return (poll); /* nothing learned yet */
+
+     elapsed = now - c->since;
+     early = c->mean - 2 * c->deviation;
+     late = c->mean + 4 * c->deviation;
+     if (elapsed + poll < early)
+          return (early - elapsed);
+     if (elapsed < late)
+          return (poll);
+     return (doubled(2 * poll, &c->backoff)); /* overdue */
+}
+
+/*-------------------------| poll functions |---------------------------*/
+
+int poll_observe(int state)
+{
+     poll_channel *c;
+     double now;
+
+     if (know_channels() != 0)
+          return (0);
+     c = &known[current_channel];
+     now = now_seconds();
+
+     if (state == -1)
+     {
+          if (!c->unreadable)
+          {
+               c->unreadable = 1;
+               c->unreadable_since = now;
+          }
+          if (state_timeout > 0 && !c->reported
+              && now - c->unreadable_since > state_timeout)
+          {
+               c->reported = 1;
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "state file unreadable for longer than state_timeout");
+               printf("Selector: %s unreadable for %.1f seconds.\n",
+                      sta_file, now - c->unreadable_since);
+               if (state_timeout_abort)
+                    return (1);
+          }
+          return (0);
+     }
+     c->unreadable = 0;
+     c->reported = 0;
+
+     if (state != c->last_state)
+          c->backoff = 0;
+     c->last_state = state;
+     if (state == 2 && !c->working)
+     {
+          c->working = 1;
+          c->since = now;
+     }
+     else if (state != 2 && c->working)
+     {
+          c->working = 0;
+          learn(c, now - c->since);
+     }
+     return (0);
+}
+
+
+double poll_interval(double poll)
+/* The shortest interval wanted by a variator still running. */
+{
+     int i;
+     double now, interval, shortest;
+
+     if (!poll_adaptive)
+          return (poll);
+
+     now = now_seconds();
+     shortest = poll_max > poll ? poll_max : poll;
+     for (i = 0; i < channel_count; i++)
+     {
+          if (channels[i].stopped)
+               continue;
+          interval = i < known_count
+               ? channel_interval(&known[i], poll, now) : poll;
+          if (interval < shortest)
+               shortest = interval;
+     }
+     return (shortest < poll ? poll : shortest);
+}
+
+
+void poll_free(void)
+{
+     free(known);
+     known = NULL;
+     known_count = 0;
+}
@@ -0,0 +1,74 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Adaptive polling.
+
+  With 'poll_adaptive 1' the time between two reads of the state files
+  is no longer the fixed 'poll' interval from the command line. For
+  every variator the time from handing it the turn (state 2) until it
+  hands it back (state 3, 5 or 9) is measured, and a smoothed mean and
+  deviation of this turnaround are kept (as for the round trip time in
+  TCP). While the variator works, FEMO
+
+  - sleeps until shortly before the expected completion (mean minus
+    twice the deviation),
+  - then polls every 'poll' seconds until the mean plus four times the
+    deviation has passed,
+  - then doubles the interval with every read, up to 'poll_max'.
+
+  Until the first turnaround is known, 'poll' is used. While no
+  variator works (e.g. before state 1 or after state 4) the interval
+  starts at 'poll' and is doubled up to 'poll_max'. With several
+  variators the shortest interval of them is used.
+
+  With 'state_timeout' an unreadable 'sta' file (missing, not
+  permitted, not a number) is reported once it has lasted this many
+  seconds, and with 'state_timeout_abort 1' FEMO stops then with an
+  error. The parameters are read in state 1, so they only apply from
+  there on.
+
+  Header file.
+
+  file: femo_poll.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_POLL_H
+#define FEMO_POLL_H
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int poll_adaptive; /* 1 if the polling interval adapts */
+
+extern double poll_max; /* longest interval in seconds */
+
+extern double state_timeout; /* seconds an unreadable state is
+                                tolerated, 0 for ever */
+
+extern int state_timeout_abort; /* 1 to stop after 'state_timeout' */
+
+/*-------------------------| functions |--------------------------------*/
+
+int poll_observe(int state);
+/* Notes the state just read from the 'sta' file of the current
+   variator (-1 if it couldn't be read).
+   Returns 0, or 1 if the state has been unreadable for longer than
+   'state_timeout' and FEMO has to stop. */
+
+double poll_interval(double poll);
+/* Returns the time in seconds to sleep before the next read, given
+   the fixed interval 'poll'. */
+
+void poll_free(void);
+/* Frees all memory and forgets the turnarounds. */
+
+#endif /* FEMO_POLL_H */
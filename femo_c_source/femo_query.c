@@ -0,0 +1,228 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Queries against the archive.
+
+  The predicted values are rounded like stored objective values, so
+  the comparisons are the ones update_archive() would make. The
+  archive backend answers, see femo_backend.h.
+
+  C file.
+
+  file: femo_query.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_backend.h"
+#include "femo_query.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int query_enabled = 0; /* 1 if the 'qry' file is answered */
+
+/* only used in this file */
+
+#define QUERY_NAME_LENGTH (FILE_NAME_LENGTH_INTERNAL + 4)
+
+static double *rounded = NULL; /* the vector queried, rounded */
+
+static int rounded_size = 0;
+
+static double *query_values = NULL; /* the vectors of the 'qry' file */
+
+static int query_values_size = 0;
+
+static int *query_results = NULL; /* 'result removed' per vector */
+
+static int query_results_size = 0;
+
+/*-------------------------| helper functions |-------------------------*/
+
+static int grow_values(double **buffer, int *size, int count)
+/* Makes '*buffer' hold at least 'count' values, as grow_ints() does.
+   Returns 0 if successful and 1 if out of memory. */
+{
+     double *tmp;
+     int new_size;
+
+     if (count <= *size)
+          return (0);
+     new_size = 2 * *size > count ? 2 * *size : count;
+     tmp = (double *) realloc(*buffer, new_size * sizeof(double));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     *buffer = tmp;
+     *size = new_size;
+     return (0);
+}
+
+
+static void query_file_name(char *name, char *suffix)
+/* Builds '<filenamebase><suffix>' from the 'var' file name of the
+   current variator. */
+{
+     strcpy(name, var_file);
+     strcpy(name + strlen(name) - 3, suffix);
+}
+
+
+static int ready_for_answer(char *name)
+/* Returns 1 if the answer file doesn't exist or contains '0'. */
+{
+     FILE *fp;
+     int control_element = 1;
+
+     fp = fopen(name, "r");
+     if (fp == NULL)
+          return (1);
+     fscanf(fp, "%d", &control_element);
+     fclose(fp);
+     return (control_element == 0);
+}
+
+/*-------------------------| query functions |--------------------------*/
+
+int femo_query(double *objective_value, int *removed)
+/* Rounds the vector and asks the archive backend. */
+{
+     int k;
+
+     *removed = 0;
+     if (query_reserve() != 0)
+          return (QUERY_ACCEPTED); /* the candidate is evaluated */
+     for (k = 0; k < dimension; k++)
+          rounded[k] = (objective_t) objective_value[k];
+
+     return (backend->query(rounded, removed));
+}
+
+
+int answer_queries(void)
+/* Reads the 'qry' file completely, then answers it. */
+{
+     FILE *fp;
+     int i, j, size, count, removed;
+     char tag[4];
+     char query_name[QUERY_NAME_LENGTH];
+     char answer_name[QUERY_NAME_LENGTH];
+
+     if (dimension <= 0)
+          return (2); /* state 1 hasn't been reached yet */
+     query_file_name(query_name, "qry");
+     query_file_name(answer_name, "ans");
+
+     fp = fopen(query_name, "r");
+     if (fp == NULL)
+          return (2);
+     if (fscanf(fp, "%d", &size) != 1 || size <= 0)
+     {
+          fclose(fp);
+          return (2); /* no query */
+     }
+     if (size % dimension != 0)
+     {
+          fclose(fp);
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "size in query file is wrong");
+          clear_file(query_name);
+          return (1);
+     }
+     if (!ready_for_answer(answer_name))
+     {
+          fclose(fp);
+          return (2);
+     }
+
+     count = size / dimension;
+     /* the buffers are kept for the run and grow with the largest
+        query */
+     if (grow_values(&query_values, &query_values_size, size) != 0
+         || grow_ints(&query_results, &query_results_size, 2 * count) != 0)
+     {
+          fclose(fp);
+          return (1);
+     }
+     for (i = 0; i < size; i++)
+     {
+          if (fscanf(fp, "%le", &query_values[i]) != 1)
+               break;
+     }
+     if (i < size || fscanf(fp, "%3s", tag) != 1 || strcmp(tag, "END") != 0)
+     {
+          /* not completely written yet */
+          fclose(fp);
+          return (2);
+     }
+     fclose(fp);
+
+     /* reset before answering, the next query may follow at once */
+     if (clear_file(query_name) != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't reset query file");
+          return (1);
+     }
+
+     for (j = 0; j < count; j++)
+     {
+          query_results[2 * j] =
+               femo_query(&query_values[j * dimension], &removed);
+          query_results[2 * j + 1] = removed;
+     }
+
+     fp = fopen(answer_name, "w");
+     if (fp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't write answer file");
+          return (1);
+     }
+     fprintf(fp, "%d\n", 2 * count);
+     for (j = 0; j < count; j++)
+          fprintf(fp, "%d %d\n", query_results[2 * j],
+                  query_results[2 * j + 1]);
+     fprintf(fp, "END");
+     fclose(fp);
+     return (0);
+}
+
+
+int query_reserve(void)
+/* Sized for 'dimension' values, the rounded vector only grows. */
+{
+     return (grow_values(&rounded, &rounded_size, dimension));
+}
+
+
+void query_free(void)
+/* Frees the buffers. */
+{
+     free(rounded);
+     free(query_values);
+     free(query_results);
+     rounded = NULL;
+     query_values = NULL;
+     query_results = NULL;
+     rounded_size = 0;
+     query_values_size = 0;
+     query_results_size = 0;
+}
@@ -0,0 +1,85 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Queries: would a predicted objective vector enter the current
+  archive? A variator with a cheap surrogate model can ask before it
+  evaluates a candidate and skip those that would be rejected anyway.
+
+  The answer is the one update_archive() would give for a single new
+  individual, the archive is not changed. A bounded archive
+  ('max_archive') may still drop an accepted individual afterwards,
+  this is not predicted.
+
+  Protocol: if 'query_files' is 1, the variator may write predicted
+  vectors to '<filenamebase>qry' while it has the turn (state 2, and
+  state 3 in the asynchronous mode):
+
+    count * dim
+    values of vector 1
+    ...
+    END
+
+  FEMO answers in '<filenamebase>ans' and resets the 'qry' file to
+  '0'. The answer has one line 'result removed' per vector (result as
+  QUERY_* below):
+
+    count * 2
+    result removed
+    ...
+    END
+
+  As with the other files the variator resets 'ans' to '0' after
+  reading it, a new query is only answered then.
+
+  Header file.
+
+  file: femo_query.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_QUERY_H
+#define FEMO_QUERY_H
+
+/* results */
+#define QUERY_ACCEPTED 0  /* the vector would enter the archive */
+#define QUERY_DOMINATED 1 /* a member dominates it (in the epsilon
+                             archive: its box is dominated or the
+                             member of its box is kept) */
+#define QUERY_EQUAL 2     /* a member has the same objective vector */
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int query_enabled; /* 1 if the 'qry' file is answered */
+
+/*-------------------------| functions |--------------------------------*/
+
+int femo_query(double *objective_value, int *removed);
+/* Checks whether an individual with the 'dimension' values in
+   'objective_value' would be accepted by the archive. '*removed' is
+   set to the number of members it would remove (0 unless accepted).
+   Returns one of the QUERY_* results. */
+
+int answer_queries(void);
+/* Answers the 'qry' file of the current variator.
+   Returns 0 if a query was answered, 2 if there was none (or the
+   previous answer is unread) and 1 if the query file is invalid. */
+
+int query_reserve(void);
+/* Makes room for a vector of 'dimension' values, so femo_query()
+   allocates nothing. The buffers of answer_queries() grow with the
+   largest query and are kept for the run.
+   Returns 0 if successful and 1 if out of memory. */
+
+void query_free(void);
+/* Frees the buffers. */
+
+#endif /* FEMO_QUERY_H */
@@ -0,0 +1,391 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Recording and replay of the offspring stream.
+
+  The trace is flushed after every batch, so after a crash it ends
+  with complete batches (or one incomplete batch, which the replay
+  ignores). During the replay the recorded parameter file is copied
+  to an anonymous temporary file (tmpfile()) and read with
+  read_parameters() as usual, so the random numbers are drawn from the
+  same seed; nothing is written next to the trace.
+
+  C file.
+
+  file: femo_record.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_trace.h"
+#include "femo_mpi.h"
+#include "femo_record.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int replay_running = 0; /* 1 during 'femo -replay' */
+
+/* only used in this file */
+
+#define RECORD_MAGIC "FEMOREC1"
+
+static FILE *record_fp = NULL; /* trace being written, NULL if none */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static int write_ints(int *values, int count)
+{
+     return (fwrite(values, sizeof(int), count, record_fp)
+             == (size_t) count ? 0 : 1);
+}
+
+
+static int read_ints(FILE *fp, int *values, int count)
+{
+     return (fread(values, sizeof(int), count, fp) == (size_t) count ? 0 : 1);
+}
+
+
+static int compare_recorded(FILE *fp, int count, int *identities,
+                            int *recorded, int compare)
+/* Reads a recorded list of identities into 'recorded' (room for
+   'count' + 1) and compares it with the 'count' ones in 'identities'
+   (only their number if 'compare' is 0).
+   Returns 0 if equal, 1 if different and -1 if the trace ends. */
+{
+     int i, size;
+
+     if (read_ints(fp, &size, 1) != 0)
+          return (-1);
+     if (size != count)
+          return (1);
+     if (read_ints(fp, recorded, size) != 0)
+          return (-1);
+     for (i = 0; i < count && compare; i++)
+          if (recorded[i] != get_local_identity(identities[i]))
+               return (1);
+     return (0);
+}
+
+/*-------------------------| record functions |-------------------------*/
+
+int record_open(char *file)
+/* Writes the header of a new trace. */
+{
+     FILE *fp;
+     char *text;
+     int header[5];
+
+     record_close();
+     fp = fopen(paramfile, "rb");
+     if (fp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't read parameter file");
+          return (1);
+     }
+     fseek(fp, 0, SEEK_END);
+     header[4] = (int) ftell(fp);
+     rewind(fp);
+     text = (char *) malloc(header[4] + 1);
+     if (text == NULL || fread(text, 1, header[4], fp) != (size_t) header[4])
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't read parameter file");
+          free(text);
+          fclose(fp);
+          return (1);
+     }
+     fclose(fp);
+
+     record_fp = fopen(file, "wb");
+     if (record_fp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't open record file");
+          free(text);
+          return (1);
+     }
+     header[0] = alpha;
+     header[1] = mu;
+     header[2] = lambda;
+     header[3] = dimension;
+     fwrite(RECORD_MAGIC, 1, 8, record_fp);
+     write_ints(header, 5);
+     fwrite(text, 1, header[4], record_fp);
+     free(text);
+     if (fflush(record_fp) != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't write record file");
+          record_close();
+          return (1);
+     }
+     return (0);
+}
+
+
+int record_batch(int size, int *identities)
+/* Appends the identities and objective values of a batch. */
+{
+     int i, k, local;
+     double value;
+
+     if (record_fp == NULL)
+          return (0);
+     write_ints(&size, 1);
+     for (i = 0; i < size; i++)
+     {
+          local = get_local_identity(identities[i]);
+          write_ints(&local, 1);
+          for (k = 0; k < dimension; k++)
+          {
+               value = get_objective_value(identities[i], k);
+               fwrite(&value, sizeof(double), 1, record_fp);
+          }
+     }
+     return (ferror(record_fp) ? 1 : 0);
+}
+
+
+int record_result(int count, int *parents)
+/* Appends the parents and the archive, then flushes the batch. */
+{
+     int i, local;
+
+     if (record_fp == NULL)
+          return (0);
+     write_ints(&count, 1);
+     for (i = 0; i < count; i++)
+     {
+          local = get_local_identity(parents[i]);
+          write_ints(&local, 1);
+     }
+     local = get_size();
+     write_ints(&local, 1);
+     for (i = get_first(); i != -1; i = get_next(i))
+     {
+          local = get_local_identity(i);
+          write_ints(&local, 1);
+     }
+     if (fflush(record_fp) != 0 || ferror(record_fp))
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't write record file");
+          return (1);
+     }
+     return (0);
+}
+
+
+void record_close(void)
+/* Closes the trace. */
+{
+     if (record_fp != NULL)
+          fclose(record_fp);
+     record_fp = NULL;
+}
+
+/*-------------------------| replay |-----------------------------------*/
+
+int replay_run(char *file)
+/* Replays all complete batches of the trace. */
+{
+     FILE *fp, *param_fp;
+     char magic[8];
+     char *text;
+     int header[5];
+     int i, count, size, capacity, mismatches, batches, individuals, result;
+     int parents_compared; /* 0 with femo_mpi, its parents depend on the
+                              parts */
+     int *identities, *parents, *recorded;
+     double *values;
+     double begin, elapsed, total, slowest;
+
+     fp = fopen(file, "rb");
+     if (fp == NULL || fread(magic, 1, 8, fp) != 8
+         || memcmp(magic, RECORD_MAGIC, 8) != 0 || read_ints(fp, header, 5) != 0
+         || header[0] <= 0 || header[1] <= 0 || header[2] <= 0
+         || header[3] <= 0 || header[4] < 0)
+     {
+          printf("Replay: %s is not a FEMO trace.\n", file);
+          if (fp != NULL)
+               fclose(fp);
+          return (1);
+     }
+
+     /* the parameter file of the recorded run, removed when closed */
+     text = (char *) malloc(header[4] + 1);
+     param_fp = tmpfile();
+     if (text == NULL || param_fp == NULL
+         || fread(text, 1, header[4], fp) != (size_t) header[4]
+         || fwrite(text, 1, header[4], param_fp) != (size_t) header[4]
+         || fseek(param_fp, 0, SEEK_SET) != 0)
+     {
+          printf("Replay: couldn't restore the parameter file.\n");
+          free(text);
+          if (param_fp != NULL)
+               fclose(param_fp);
+          fclose(fp);
+          return (1);
+     }
+     free(text);
+
+     if (init_channels(1, &file) != 0)
+     {
+          fclose(param_fp);
+          fclose(fp);
+          return (1);
+     }
+     alpha = header[0];
+     mu = header[1];
+     lambda = header[2];
+     dimension = header[3];
+     replay_running = 1;
+     result = read_parameters(param_fp);
+     if (result != 0)
+     {
+          printf("Replay: couldn't read the recorded parameters.\n");
+          fclose(fp);
+          return (1);
+     }
+     start_run();
+     parents_compared = !mpi_active;
+
+     capacity = alpha > lambda ? alpha : lambda;
+     identities = (int *) malloc(capacity * sizeof(int));
+     parents = (int *) malloc(mu * sizeof(int));
+     values = (double *) malloc(dimension * sizeof(double));
+     recorded = NULL;
+     if (identities == NULL || parents == NULL || values == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          fclose(fp);
+          return (1);
+     }
+
+     mismatches = 0;
+     batches = 0;
+     individuals = 0;
+     total = 0;
+     slowest = 0;
+     result = 0;
+     while (result == 0 && read_ints(fp, &count, 1) == 0)
+     {
+          if (count != (batches == 0 ? alpha : lambda))
+          {
+               printf("Replay: batch %d has a wrong size.\n", batches);
+               result = 1;
+               break;
+          }
+          for (i = 0; i < count && result == 0; i++)
+          {
+               if (read_ints(fp, &identities[i], 1) != 0
+                   || fread(values, sizeof(double), dimension, fp)
+                   != (size_t) dimension)
+               {
+                    result = -1; /* incomplete batch */
+                    break;
+               }
+               identities[i] = get_identity(0, identities[i]);
+               if (identities[i] == -1
+                   || add_individual(identities[i], values) != 0)
+               {
+                    printf("Replay: batch %d is invalid.\n", batches);
+                    result = 1;
+               }
+          }
+          if (result != 0)
+               break;
+
+          if (batches > 0)
+               generation++;
+          begin = trace_begin();
+          if (run_selection(count, identities, parents) != 0)
+          {
+               printf("Replay: selection failed in batch %d.\n", batches);
+               result = 1;
+               break;
+          }
+          elapsed = trace_begin() - begin;
+
+          /* recorded parents and archive */
+          if (get_size() + mu > capacity)
+          {
+               capacity = get_size() + mu;
+               free(identities);
+               identities = (int *) malloc(capacity * sizeof(int));
+          }
+          free(recorded);
+          recorded = (int *) malloc((capacity + 1) * sizeof(int));
+          if (identities == NULL || recorded == NULL)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "selector out of memory");
+               result = 1;
+               break;
+          }
+          i = compare_recorded(fp, orphaned ? 0 : mu, parents, recorded,
+                               parents_compared);
+          if (i == 0)
+          {
+               size = 0;
+               for (i = get_first(); i != -1; i = get_next(i))
+                    identities[size++] = i;
+               i = compare_recorded(fp, size, identities, recorded, 1);
+          }
+          if (i == -1)
+          {
+               result = -1;
+               break;
+          }
+          if (i == 1)
+          {
+               if (mismatches == 0)
+                    printf("Replay: first mismatch in generation %d.\n",
+                           generation);
+               mismatches++;
+               break; /* the rest of the trace refers to another archive */
+          }
+          batches++;
+          individuals += count;
+          total += elapsed;
+          if (elapsed > slowest)
+               slowest = elapsed;
+     }
+     fclose(fp);
+
+     if (result == -1)
+          printf("Replay: the trace ends with an incomplete batch.\n");
+     printf("Replay: %d generations, %d individuals, archive size %d\n",
+            batches, individuals, get_size());
+     if (batches > 0)
+          printf("Replay: selection %.6f s in total, %.1f us per generation, "
+                 "slowest %.1f us\n", total * 1e-6, total / batches, slowest);
+     printf("Replay: %s\n", mismatches == 0 && result != 1
+            ? (parents_compared ? "archive and parents match"
+               : "archive matches") : "MISMATCH");
+
+     free(identities);
+     free(parents);
+     free(values);
+     free(recorded);
+     state6();
+     clean_population();
+     return (mismatches == 0 && result != 1 ? 0 : 1);
+}
@@ -0,0 +1,70 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Recording and replay of the offspring stream.
+
+  With 'record_file' every batch of new individuals (the 'ini' file
+  and each 'var' file) is appended to a binary trace, together with
+  the parents selected and the resulting archive. The trace starts
+  with the common parameters and the text of the parameter file,
+  which includes the seed.
+
+  'femo -replay tracefile' feeds the batches through run_selection()
+  again, without files and polling, checks the parents and the archive
+  of every generation and reports the time spent in the selection.
+
+  Layout (native byte order, no padding):
+
+    "FEMOREC1", int alpha, mu, lambda, dim, int length, parameter file
+    per batch: int count, count times (int identity, dim doubles),
+               int parents, parent identities,
+               int size, archive identities
+
+  Header file.
+
+  file: femo_record.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_RECORD_H
+#define FEMO_RECORD_H
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int replay_running; /* 1 during 'femo -replay' */
+
+/*-------------------------| functions |--------------------------------*/
+
+int record_open(char *file);
+/* Starts a new trace in 'file' with the current common parameters and
+   the contents of 'paramfile'.
+   Returns 0 if successful and 1 otherwise. */
+
+int record_batch(int size, int *identities);
+/* Appends the 'size' new individuals in 'identities' (already in the
+   global population). Does nothing without a trace.
+   Returns 0 if successful and 1 otherwise. */
+
+int record_result(int count, int *parents);
+/* Completes the batch with the 'count' parents selected and the
+   current archive. Does nothing without a trace.
+   Returns 0 if successful and 1 otherwise. */
+
+void record_close(void);
+/* Closes the trace. */
+
+int replay_run(char *file);
+/* Replays the trace in 'file' and prints the result.
+   Returns 0 if archive and parents matched in every generation and 1
+   otherwise. */
+
+#endif /* FEMO_RECORD_H */
@@ -0,0 +1,343 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Searches in the objective space of the archive.
+
+  A box is searched along the objective with the fewest members in
+  its interval, which tree_rank() tells in O(log n). The nearest
+  members are searched outwards from the target along the first
+  objective: the scaled gap in this objective is a lower bound of the
+  distance, so the walk stops in a direction as soon as the gap
+  exceeds the k-th distance found.
+
+  C file.
+
+  file: femo_search.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <limits.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_tree.h"
+#include "femo_backend.h"
+#include "femo_search.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+/* only used in this file */
+
+static tree *index_trees = NULL; /* one per objective */
+
+static int index_dimension = 0; /* trees allocated */
+
+static int index_ready = 0; /* 1 if the trees hold the archive */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static double value_of(int identity, int objective)
+{
+     return (get_individual(identity)->objective_value[objective]);
+}
+
+
+static int has_nan(int identity)
+{
+     int k;
+
+     for (k = 0; k < dimension; k++)
+     {
+          if (value_of(identity, k) != value_of(identity, k))
+               return (1);
+     }
+     return (0);
+}
+
+
+static int compare_ints(const void *a, const void *b)
+{
+     return (*(const int *) a - *(const int *) b);
+}
+
+
+static int add_member(int identity)
+/* Inserts a member into all trees. Returns 0 if successful and 1 if
+   out of memory. */
+{
+     int k;
+
+     if (has_nan(identity))
+          return (0);
+     for (k = 0; k < dimension; k++)
+     {
+          if (tree_insert(&index_trees[k], value_of(identity, k),
+                          identity) != 0)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "selector out of memory");
+               return (1);
+          }
+     }
+     return (0);
+}
+
+
+static int build_index(void)
+/* Indexes the archive unless it is indexed already. Returns 0 if
+   successful and 1 if out of memory. */
+{
+     int k, id;
+
+     if (index_ready)
+          return (0);
+     if (index_dimension != dimension)
+     {
+          search_free();
+          index_trees = (tree *) malloc(dimension * sizeof(tree));
+          if (index_trees == NULL)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "selector out of memory");
+               return (1);
+          }
+          for (k = 0; k < dimension; k++)
+               tree_init(&index_trees[k]);
+          index_dimension = dimension;
+     }
+     if (search_reserve(work_capacity) != 0)
+          return (1);
+     for (id = backend->first(); id != -1; id = backend->next(id))
+     {
+          if (add_member(id) != 0)
+          {
+               search_clear();
+               return (1);
+          }
+     }
+     index_ready = 1;
+     return (0);
+}
+
+
+static double distance_to(int identity, double *target, double *scale)
+{
+     int k;
+     double d, sum = 0;
+
+     for (k = 0; k < dimension; k++)
+     {
+          d = (value_of(identity, k) - target[k]) / scale[k];
+          sum += d * d;
+     }
+     return (sqrt(sum));
+}
+
+/*-------------------------| search functions |-------------------------*/
+
+int search_range(double *lower, double *upper, int *identities)
+/* Walks the most selective objective and checks the others. */
+{
+     int i, k, node, id, inside, count, fewest, best;
+     tree *t;
+
+     if (build_index() != 0)
+          return (-1);
+     best = 0;
+     fewest = INT_MAX;
+     for (k = 0; k < dimension; k++)
+     {
+          count = tree_rank(&index_trees[k], upper[k], INT_MAX)
+               - tree_rank(&index_trees[k], lower[k], -1);
+          if (count < fewest)
+          {
+               fewest = count;
+               best = k;
+          }
+     }
+     if (fewest <= 0)
+          return (0); /* also if a bound is NaN */
+
+     t = &index_trees[best];
+     count = 0;
+     node = tree_higher(t, lower[best], -1);
+     while (node != -1 && TREE_KEY(t, node) <= upper[best])
+     {
+          id = TREE_IDENTITY(t, node);
+          inside = 1;
+          for (i = 0; i < dimension && inside; i++)
+               inside = value_of(id, i) >= lower[i]
+                    && value_of(id, i) <= upper[i];
+          if (inside)
+               identities[count++] = id;
+          node = tree_higher(t, TREE_KEY(t, node), id);
+     }
+     qsort(identities, count, sizeof(int), compare_ints);
+     return (count);
+}
+
+
+int search_nearest(double *target, int k, int *identities,
+                   double *distances)
+/* Walks outwards from the target along the first objective. */
+{
+     int i, count, lower, higher, node, id;
+     double gap_lower, gap_higher, gap, d;
+     double *scale;
+     tree *t;
+
+     if (build_index() != 0)
+          return (-1);
+     if (k <= 0 || tree_size(&index_trees[0]) == 0)
+          return (0);
+     for (i = 0; i < dimension; i++)
+     {
+          if (target[i] != target[i])
+               return (0);
+     }
+     scale = (double *) malloc(dimension * sizeof(double));
+     if (scale == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (-1);
+     }
+     for (i = 0; i < dimension; i++)
+     {
+          t = &index_trees[i];
+          scale[i] = TREE_KEY(t, tree_last(t)) - TREE_KEY(t, tree_first(t));
+          if (scale[i] <= 0)
+               scale[i] = 1;
+     }
+
+     t = &index_trees[0];
+     lower = tree_lower(t, target[0], -1);
+     higher = tree_higher(t, target[0], -1);
+     count = 0;
+     while (lower != -1 || higher != -1)
+     {
+          gap_lower = lower != -1
+               ? (target[0] - TREE_KEY(t, lower)) / scale[0] : HUGE_VAL;
+          gap_higher = higher != -1
+               ? (TREE_KEY(t, higher) - target[0]) / scale[0] : HUGE_VAL;
+          node = gap_lower <= gap_higher ? lower : higher;
+          gap = gap_lower <= gap_higher ? gap_lower : gap_higher;
+          if (count == k && gap > distances[k - 1])
+               break; /* all others are farther */
+
+          id = TREE_IDENTITY(t, node);
+          d = distance_to(id, target, scale);
+          if (count < k || d < distances[count - 1]
+              || (d == distances[count - 1] && id < identities[count - 1]))
+          {
+               /* insertion into the sorted list */
+               i = count < k ? count++ : count - 1;
+               while (i > 0 && (distances[i - 1] > d
+                                || (distances[i - 1] == d
+                                    && identities[i - 1] > id)))
+               {
+                    distances[i] = distances[i - 1];
+                    identities[i] = identities[i - 1];
+                    i--;
+               }
+               distances[i] = d;
+               identities[i] = id;
+          }
+
+          if (node == lower)
+               lower = tree_lower(t, TREE_KEY(t, node), id);
+          else
+               higher = tree_higher(t, TREE_KEY(t, node), id);
+     }
+     free(scale);
+     return (count);
+}
+
+
+int search_extremes(int objective, int *lowest, int *highest)
+{
+     tree *t;
+
+     if (objective < 0 || objective >= dimension || build_index() != 0)
+          return (1);
+     t = &index_trees[objective];
+     if (tree_size(t) == 0)
+          return (1);
+     *lowest = TREE_IDENTITY(t, tree_first(t));
+     /* of equal values the lowest identity, as for 'lowest' */
+     *highest = TREE_IDENTITY(t, tree_higher(t, TREE_KEY(t, tree_last(t)),
+                                             -1));
+     return (0);
+}
+
+
+int search_reserve(int count)
+{
+     int k;
+
+     for (k = 0; k < index_dimension; k++)
+     {
+          if (tree_reserve(&index_trees[k], count) != 0)
+               return (1);
+     }
+     return (0);
+}
+
+
+int search_insert(int identity)
+{
+     if (!index_ready)
+          return (0);
+     if (add_member(identity) != 0)
+     {
+          search_clear(); /* partly inserted, built again next time */
+          return (1);
+     }
+     return (0);
+}
+
+
+int search_remove(int identity)
+{
+     int k;
+
+     if (!index_ready || has_nan(identity))
+          return (0);
+     for (k = 0; k < dimension; k++)
+          tree_remove(&index_trees[k], value_of(identity, k), identity);
+     return (0);
+}
+
+
+void search_clear(void)
+{
+     int k;
+
+     for (k = 0; k < index_dimension; k++)
+          tree_clear(&index_trees[k]);
+     index_ready = 0;
+}
+
+
+void search_free(void)
+{
+     int k;
+
+     for (k = 0; k < index_dimension; k++)
+          tree_free(&index_trees[k]);
+     free(index_trees);
+     index_trees = NULL;
+     index_dimension = 0;
+     index_ready = 0;
+}
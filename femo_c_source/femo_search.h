@@ -0,0 +1,77 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Searches in the objective space of the archive: all members inside
+  a box, the k members nearest to a point and the members with the
+  lowest and highest value of an objective.
+
+  The archive is indexed by one ordered tree per objective. The index
+  is built on the first search and kept up to date with the archive
+  from then on, so runs that never search don't pay for it. Searches
+  take O(log n) plus the members looked at; they don't change the
+  archive and are answered between two selections (in the daemon
+  mode with the SEARCH message, see femo_session.h).
+
+  Distances for the nearest members are Euclidean after scaling each
+  objective by the range of its values in the archive (objectives
+  with a single value aren't scaled). Members with a NaN value are
+  not indexed and never found.
+
+  Header file.
+
+  file: femo_search.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_SEARCH_H
+#define FEMO_SEARCH_H
+
+/*-------------------------| functions |--------------------------------*/
+
+int search_range(double *lower, double *upper, int *identities);
+/* Stores the identities of all members with
+   lower[i] <= value[i] <= upper[i] for every objective i in ascending
+   order in 'identities' (room for get_size()).
+   Returns their number, -1 if out of memory. */
+
+int search_nearest(double *target, int k, int *identities,
+                   double *distances);
+/* Stores the identities of the 'k' members nearest to 'target' and
+   their scaled distances, nearest first (ties by identity).
+   Returns their number (less than 'k' if the archive is smaller), -1
+   if out of memory. */
+
+int search_extremes(int objective, int *lowest, int *highest);
+/* Stores the members with the lowest and the highest value of
+   'objective' (from 0; of equal values the lowest identity).
+   Returns 0 if successful and 1 if the archive is empty or out of
+   memory. */
+
+int search_reserve(int count);
+/* Makes room for 'count' members in the index, if there is one (a
+   new index is sized for 'work_capacity'). Returns 0 if successful
+   and 1 if out of memory. */
+
+int search_insert(int identity);
+/* Adds the new member 'identity' to the index, if there is one.
+   Returns 0 if successful and 1 if out of memory. */
+
+int search_remove(int identity);
+/* Removes 'identity' from the index, if it is indexed. Returns 0. */
+
+void search_clear(void);
+/* Drops the index, the next search builds it again. */
+
+void search_free(void);
+/* Frees all memory. */
+
+#endif /* FEMO_SEARCH_H */
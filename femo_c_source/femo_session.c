@@ -0,0 +1,434 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Sessions of the daemon mode.
+
+  A worker handles its session with blocking reads, the selection is
+  the one of state1() and state3() (see run_selection()).
+
+  C file.
+
+  file: femo_session.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_session.h"
+#include "femo_search.h"
+
+#ifdef PISA_UNIX
+#include <unistd.h>
+#endif
+
+/*--------------------| global variable definitions |-------------------*/
+
+int daemon_enabled = 0; /* 1 in the daemon and its workers */
+
+#ifdef PISA_UNIX
+
+/* only used in this file */
+
+#define MAX_MESSAGE_LENGTH (1 << 30) /* larger messages are refused */
+
+static char *message = NULL; /* payload of the last message received */
+
+static int message_capacity = 0; /* bytes allocated for 'message' */
+
+static int slot_fd = -1; /* socket to the daemon for the selection
+                            slots, -1 for no limit */
+
+/*-------------------------| message functions |------------------------*/
+
+static int read_full(int fd, void *buffer, size_t count)
+/* Reads exactly 'count' bytes. Returns 0 if successful and 1 if the
+   connection was closed or failed. */
+{
+     char *p = buffer;
+     ssize_t n;
+
+     while (count > 0)
+     {
+          n = read(fd, p, count);
+          if (n < 0 && errno == EINTR)
+               continue;
+          if (n <= 0)
+               return (1);
+          p += n;
+          count -= n;
+     }
+     return (0);
+}
+
+
+static int write_full(int fd, void *buffer, size_t count)
+/* Writes exactly 'count' bytes. Returns 0 if successful and 1
+   otherwise. */
+{
+     char *p = buffer;
+     ssize_t n;
+
+     while (count > 0)
+     {
+          n = write(fd, p, count);
+          if (n < 0 && errno == EINTR)
+               continue;
+          if (n <= 0)
+               return (1);
+          p += n;
+          count -= n;
+     }
+     return (0);
+}
+
+
+static int send_message(int fd, int type, void *payload, int length)
+{
+     int header[2];
+
+     header[0] = type;
+     header[1] = length;
+     if (write_full(fd, header, sizeof(header)) != 0
+         || (length > 0 && write_full(fd, payload, length) != 0))
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't send message");
+          return (1);
+     }
+     return (0);
+}
+
+
+static int send_error(int fd, char *text)
+/* Logs 'text' and sends it to the client. Returns 1. */
+{
+     log_to_file(log_file, __FILE__, __LINE__, text);
+     send_message(fd, SESSION_ERROR, text, strlen(text));
+     return (1);
+}
+
+
+static int receive_message(int fd, int *type, int *length)
+/* Reads a message, its payload is stored in 'message'. Returns 0 if
+   successful and 1 if the connection was closed or the message is
+   too long. */
+{
+     int header[2];
+     char *tmp;
+
+     if (read_full(fd, header, sizeof(header)) != 0)
+          return (1);
+     if (header[1] < 0 || header[1] > MAX_MESSAGE_LENGTH)
+          return (send_error(fd, "message too long"));
+     if (header[1] > message_capacity)
+     {
+          tmp = (char *) realloc(message, header[1]);
+          if (tmp == NULL)
+               return (send_error(fd, "selector out of memory"));
+          message = tmp;
+          message_capacity = header[1];
+     }
+     if (header[1] > 0 && read_full(fd, message, header[1]) != 0)
+          return (1);
+     *type = header[0];
+     *length = header[1];
+     return (0);
+}
+
+/*-------------------------| slot functions |---------------------------*/
+
+static int acquire_slot(void)
+/* Waits until the daemon grants a selection slot.
+   Returns 0 if successful and 1 if the daemon has gone. */
+{
+     char byte = SLOT_ACQUIRE;
+
+     if (slot_fd == -1)
+          return (0);
+     if (write_full(slot_fd, &byte, 1) != 0
+         || read_full(slot_fd, &byte, 1) != 0 || byte != SLOT_GRANT)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't get a selection slot");
+          return (1);
+     }
+     return (0);
+}
+
+
+static int release_slot(void)
+/* Gives the slot back. Returns 0 if successful and 1 otherwise. */
+{
+     char byte = SLOT_RELEASE;
+
+     if (slot_fd == -1)
+          return (0);
+     return (write_full(slot_fd, &byte, 1));
+}
+
+/*-------------------------| session functions |------------------------*/
+
+static int open_session(int fd, char *name)
+/* Waits for the OPEN message and sets up the selector. */
+{
+     int type, length;
+     int values[5];
+
+     if (receive_message(fd, &type, &length) != 0)
+          return (1);
+     if (type != SESSION_OPEN || length != sizeof(values))
+          return (send_error(fd, "session has to start with OPEN"));
+     memcpy(values, message, sizeof(values));
+     if (values[0] <= 0 || values[1] <= 0 || values[2] <= 0 || values[3] <= 0)
+          return (send_error(fd, "alpha, mu, lambda and dim must be positive"));
+
+     /* the files of the channel are never used */
+     if (init_channels(1, &name) != 0)
+          return (send_error(fd, "couldn't set up the session"));
+     alpha = values[0];
+     mu = values[1];
+     lambda = values[2];
+     dimension = values[3];
+
+     if (read_local_parameters() != 0)
+          return (send_error(fd, "couldn't read local parameters"));
+     srand(values[4]); /* replaces the seed of the parameter file */
+     start_run();
+     return (send_message(fd, SESSION_READY, NULL, 0));
+}
+
+
+static int serve_batch(int fd, int count, int length, int *identities,
+                       int *parents)
+/* Adds the individuals of a BATCH message, selects and answers. */
+{
+     int i, j, size, record;
+     double *values;
+     int *reply;
+     char *p;
+
+     record = sizeof(int) + dimension * sizeof(double);
+     if (length != (int) sizeof(int) + count * record)
+          return (send_error(fd, "size of BATCH is wrong"));
+
+     values = (double *) malloc(dimension * sizeof(double));
+     if (values == NULL)
+          return (send_error(fd, "selector out of memory"));
+     p = message + sizeof(int);
+     for (j = 0; j < count; j++)
+     {
+          memcpy(&identities[j], p, sizeof(int));
+          memcpy(values, p + sizeof(int), dimension * sizeof(double));
+          p += record;
+          identities[j] = get_identity(0, identities[j]);
+          if (identities[j] == -1 || get_individual(identities[j]) != NULL)
+          {
+               free(values);
+               return (send_error(fd, "identity in BATCH is invalid"));
+          }
+          if (add_individual(identities[j], values) != 0)
+          {
+               free(values);
+               return (send_error(fd, "couldn't add individual"));
+          }
+     }
+     free(values);
+
+     if (run_selection(count, identities, parents) != 0)
+          return (send_error(fd, "selection failed"));
+
+     /* finished, mu parents, archive size and members */
+     size = get_size();
+     reply = (int *) malloc((3 + mu + size) * sizeof(int));
+     if (reply == NULL)
+          return (send_error(fd, "selector out of memory"));
+     reply[0] = is_finished();
+     reply[1] = orphaned ? 0 : mu;
+     for (i = 0; i < reply[1]; i++)
+          reply[2 + i] = get_local_identity(parents[i]);
+     reply[2 + reply[1]] = size;
+     j = 3 + reply[1];
+     for (i = get_first(); i != -1; i = get_next(i))
+          reply[j++] = get_local_identity(i);
+     i = send_message(fd, SESSION_SELECTION, reply, j * sizeof(int));
+     free(reply);
+     return (i);
+}
+
+
+static int serve_search(int fd, int length)
+/* Answers a SEARCH message with FOUND. */
+{
+     int i, k, kind, parameter, count, record, local;
+     int *found;
+     double value;
+     double *a, *b, *distances;
+     char *reply, *p;
+
+     if (length != (int) (2 * sizeof(int) + 2 * dimension * sizeof(double)))
+          return (send_error(fd, "size of SEARCH is wrong"));
+     memcpy(&kind, message, sizeof(int));
+     memcpy(&parameter, message + sizeof(int), sizeof(int));
+
+     a = (double *) malloc(2 * dimension * sizeof(double));
+     found = (int *) malloc((get_size() + 2) * sizeof(int));
+     distances = (double *) malloc((get_size() + 2) * sizeof(double));
+     if (a == NULL || found == NULL || distances == NULL)
+     {
+          free(a);
+          free(found);
+          free(distances);
+          return (send_error(fd, "selector out of memory"));
+     }
+     memcpy(a, message + 2 * sizeof(int), 2 * dimension * sizeof(double));
+     b = a + dimension;
+
+     if (kind == SEARCH_RANGE)
+          count = search_range(a, b, found);
+     else if (kind == SEARCH_NEAREST)
+          count = search_nearest(a, parameter < get_size() ? parameter
+                                 : get_size(), found, distances);
+     else if (kind == SEARCH_EXTREMES)
+          count = search_extremes(parameter, &found[0], &found[1]) == 0
+               ? 2 : 0;
+     else
+          count = -2;
+     free(a);
+     free(distances);
+     if (count < 0)
+     {
+          free(found);
+          return (send_error(fd, count == -2 ? "unknown kind of SEARCH"
+                             : "search failed"));
+     }
+
+     /* count, then identity and values of each member */
+     record = sizeof(int) + dimension * sizeof(double);
+     reply = (char *) malloc(sizeof(int) + count * record);
+     if (reply == NULL)
+     {
+          free(found);
+          return (send_error(fd, "selector out of memory"));
+     }
+     memcpy(reply, &count, sizeof(int));
+     p = reply + sizeof(int);
+     for (i = 0; i < count; i++)
+     {
+          local = get_local_identity(found[i]);
+          memcpy(p, &local, sizeof(int));
+          p += sizeof(int);
+          for (k = 0; k < dimension; k++)
+          {
+               value = get_objective_value(found[i], k);
+               memcpy(p, &value, sizeof(double));
+               p += sizeof(double);
+          }
+     }
+     i = send_message(fd, SESSION_FOUND, reply, sizeof(int) + count * record);
+     free(reply);
+     free(found);
+     return (i);
+}
+
+
+int session_run(int fd, int slot, char *name)
+/* Serves one connection until CLOSE. */
+{
+     int type, length, count;
+     int result = 0;
+     int started = 0; /* 1 after the initial population */
+     int *identities, *parents;
+
+     slot_fd = slot;
+     if (open_session(fd, name) != 0)
+          return (1);
+
+     identities = (int *) malloc((alpha > lambda ? alpha : lambda)
+                                 * sizeof(int));
+     parents = (int *) malloc(mu * sizeof(int));
+     if (identities == NULL || parents == NULL)
+          result = send_error(fd, "selector out of memory");
+
+     while (result == 0)
+     {
+          if (receive_message(fd, &type, &length) != 0)
+          {
+               result = 1;
+               break;
+          }
+          if (type == SESSION_CLOSE)
+               break;
+          if (type == SESSION_SEARCH)
+          {
+               if (acquire_slot() != 0)
+                    result = send_error(fd, "daemon has stopped");
+               else
+                    result = serve_search(fd, length) | release_slot();
+               continue;
+          }
+          if (type != SESSION_BATCH || length < (int) sizeof(int))
+          {
+               result = send_error(fd, "unexpected message");
+               break;
+          }
+          memcpy(&count, message, sizeof(int));
+          if (count != (started ? lambda : alpha))
+          {
+               result = send_error(fd, "number of individuals in BATCH is wrong");
+               break;
+          }
+          if (started)
+               generation++;
+          started = 1;
+          if (acquire_slot() != 0)
+               result = send_error(fd, "daemon has stopped");
+          else
+               result = serve_batch(fd, count, length, identities, parents)
+                    | release_slot();
+     }
+
+     free(identities);
+     free(parents);
+     state6();
+     clean_population();
+     return (result);
+}
+
+
+int session_refuse(int fd, char *text)
+/* Only the ERROR message, the client's OPEN isn't read. */
+{
+     return (send_error(fd, text));
+}
+
+#else /* no daemon mode on other systems */
+
+int session_run(int fd, int slot, char *name)
+{
+     log_to_file(log_file, __FILE__, __LINE__,
+                 "daemon mode needs Linux");
+     return (1);
+}
+
+
+int session_refuse(int fd, char *text)
+{
+     return (1);
+}
+
+#endif /* PISA_UNIX */
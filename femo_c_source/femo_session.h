@@ -0,0 +1,100 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Sessions of the daemon mode: one optimization over a connected
+  socket, run in a process of its own forked by the daemon (see
+  femo_daemon.h).
+
+  A session asks the daemon for a selection slot over a socket pair
+  before it serves a BATCH or SEARCH and gives the slot back
+  afterwards, so at most 'workers' sessions select at the same time;
+  the others wait for a slot while their clients wait for the answer.
+  A session that only waits for its client holds no slot. A client
+  connecting while DAEMON_MAX_SESSIONS sessions are open gets an
+  ERROR at once and the connection is closed.
+
+  Messages consist of a header (two 'int': type and number of bytes
+  that follow) and a payload in the native byte order:
+
+    OPEN      client   int alpha, mu, lambda, dim, seed
+    READY     daemon   -
+    BATCH     client   int count, then count times (int identity,
+                       dim doubles); alpha individuals in the first
+                       batch, lambda in every further one
+    SELECTION daemon   int finished, int count, count parent
+                       identities, int size, size archive identities
+    CLOSE     client   -
+    ERROR     daemon   text of the error, the session ends
+    SEARCH    client   int kind, int parameter, dim doubles a,
+                       dim doubles b (see below); any time after
+                       OPEN, between the batches
+    FOUND     daemon   int count, then count times (int identity,
+                       dim doubles)
+
+  Kinds of SEARCH (see femo_search.h):
+
+    SEARCH_RANGE     members with a <= values <= b, ascending
+                     identities; 'parameter' is ignored
+    SEARCH_NEAREST   the 'parameter' members nearest to a, nearest
+                     first; b is ignored
+    SEARCH_EXTREMES  the members with the lowest and the highest value
+                     of objective 'parameter' (from 0), none if the
+                     archive is empty; a and b are ignored
+
+  Header file.
+
+  file: femo_session.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_SESSION_H
+#define FEMO_SESSION_H
+
+/* message types */
+#define SESSION_OPEN 1
+#define SESSION_READY 2
+#define SESSION_BATCH 3
+#define SESSION_SELECTION 4
+#define SESSION_CLOSE 5
+#define SESSION_ERROR 6
+#define SESSION_SEARCH 7
+#define SESSION_FOUND 8
+
+/* kinds of SEARCH */
+#define SEARCH_RANGE 1
+#define SEARCH_NEAREST 2
+#define SEARCH_EXTREMES 3
+
+/* bytes on the slot socket pair between a session and the daemon */
+#define SLOT_ACQUIRE 'a' /* session: wants a slot */
+#define SLOT_GRANT 'g'   /* daemon: the slot is granted */
+#define SLOT_RELEASE 'r' /* session: gives the slot back */
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int daemon_enabled; /* 1 in the daemon and its workers */
+
+/*-------------------------| functions |--------------------------------*/
+
+int session_run(int fd, int slot, char *name);
+/* Serves the session on the connected socket 'fd' until the client
+   sends CLOSE. Every selection and search holds a slot of the daemon,
+   asked for on the socket 'slot' (-1 for no limit). 'name' is used
+   for the (unused) file names of the channel. Frees all memory of the
+   selector at the end.
+   Returns 0 if successful and 1 otherwise. */
+
+int session_refuse(int fd, char *text);
+/* Sends ERROR with 'text' to a client without starting a session.
+   Returns 1. */
+
+#endif /* FEMO_SESSION_H */
@@ -0,0 +1,485 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  File-backed storage of the individuals.
+
+  The file starts with a header of STORE_HEADER_SIZE bytes followed by
+  fixed-size records. A record is alive in the image if it was added
+  in or before the last completed generation and not removed up to
+  then. Records removed in the current generation are only reused
+  after it has been completed, so a crash in the middle of a
+  generation never overwrites a record of the image.
+
+  Huge pages are requested with madvise(), the kernel ignores this for
+  file systems that don't support them.
+
+  C file.
+
+  file: femo_store.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "selector_internal.h"
+#include "femo_alloc.h"
+#include "femo_store.h"
+
+#ifdef PISA_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*--------------------| global variable definitions |-------------------*/
+
+int store_enabled = 0; /* 1 while an archive file is open */
+
+#ifdef PISA_UNIX
+
+/* start of the archive file */
+typedef struct store_header_t
+{
+     char magic[8];      /* "FEMOARC1" */
+     int objective_size; /* sizeof(objective_t) */
+     int dimension;      /* number of objectives */
+     int stride;         /* bytes per record */
+     int slots;          /* number of records ever used */
+     int completed;      /* last completed generation, -1 if none */
+     int selecting;      /* 1 if the next generation has been started */
+} store_header;
+
+/* one individual */
+typedef struct store_record_t
+{
+     int identity; /* -1 if the record is not part of the image */
+     int counter;  /* number of times chosen as parent */
+     int added;    /* generation in which the individual was added */
+     int removed;  /* generation in which it was removed, -1 if alive */
+     objective_t objective_value[]; /* 'dimension' values */
+} store_record;
+
+/* only used in this file */
+
+static int store_fd = -1;
+
+static char *store_base = NULL; /* start of the mapping */
+
+static size_t store_reserved = 0; /* length of the mapping */
+
+static store_header *store_head = NULL; /* == store_base */
+
+static int store_capacity = 0; /* records that fit into the file */
+
+static int *store_free_slots = NULL; /* records that can be reused */
+
+static int store_free_count = 0;
+
+static int *store_pending = NULL; /* records removed in this generation */
+
+static int store_pending_count = 0;
+
+static int store_list_capacity = 0; /* length of both lists */
+
+static int store_restore_slot = -1; /* record for the next store_alloc() */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static store_record *record(int slot)
+{
+     return ((store_record *) (store_base + STORE_HEADER_SIZE
+                               + (size_t) slot * store_head->stride));
+}
+
+
+static int record_stride(void)
+{
+     int stride;
+
+     stride = sizeof(store_record) + dimension * sizeof(objective_t);
+     return ((stride + 7) / 8 * 8);
+}
+
+
+static int grow_lists(int capacity)
+/* Makes both lists of records hold 'capacity' slots. */
+{
+     int *tmp;
+
+     if (capacity <= store_list_capacity)
+          return (0);
+     tmp = (int *) realloc(store_free_slots, capacity * sizeof(int));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     store_free_slots = tmp;
+     tmp = (int *) realloc(store_pending, capacity * sizeof(int));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     store_pending = tmp;
+     store_list_capacity = capacity;
+     return (0);
+}
+
+
+static int resize_file(int capacity)
+/* Makes the file large enough for 'capacity' records, and the lists
+   (which never hold more records than the file) as well. */
+{
+     size_t size;
+
+     size = STORE_HEADER_SIZE + (size_t) capacity * record_stride();
+     if (size > store_reserved || ftruncate(store_fd, size) != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't enlarge archive file");
+          return (1);
+     }
+     store_capacity = capacity;
+     alloc_grown(); /* doubles with the records ever used */
+     return (grow_lists(capacity));
+}
+
+
+static int push(int **list, int *count, int slot)
+/* Appends 'slot' to one of the lists of records. */
+{
+     if (*count == store_list_capacity
+         && grow_lists(store_list_capacity == 0 ? 1024
+                       : store_list_capacity * 2) != 0)
+          return (1);
+     (*list)[(*count)++] = slot;
+     return (0);
+}
+
+
+static int valid_image(void)
+/* Returns 1 if the file holds an image for this configuration. */
+{
+     struct stat info;
+
+     if (fstat(store_fd, &info) != 0 || info.st_size < STORE_HEADER_SIZE)
+          return (0);
+     if (memcmp(store_head->magic, "FEMOARC1", 8) != 0
+         || store_head->objective_size != sizeof(objective_t)
+         || store_head->dimension != dimension
+         || store_head->stride != record_stride()
+         || store_head->slots < 0
+         || STORE_HEADER_SIZE + (size_t) store_head->slots
+         * store_head->stride > (size_t) info.st_size)
+          return (0);
+     store_capacity = (info.st_size - STORE_HEADER_SIZE) / store_head->stride;
+     return (1);
+}
+
+
+static int restore_image(void)
+/* Adds the individuals of the image to the global population. */
+{
+     int slot, k;
+     int completed;
+     store_record *r;
+     double *objective_value;
+
+     objective_value = (double *) malloc(dimension * sizeof(double));
+     if (objective_value == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+
+     completed = store_head->completed;
+     for (slot = 0; slot < store_head->slots; slot++)
+     {
+          r = record(slot);
+          if (r->identity < 0 || r->added > completed
+              || (r->removed != -1 && r->removed <= completed))
+          {
+               r->identity = -1;
+               if (push(&store_free_slots, &store_free_count, slot) != 0)
+               {
+                    free(objective_value);
+                    return (1);
+               }
+               continue;
+          }
+
+          r->removed = -1;
+          for (k = 0; k < dimension; k++)
+               objective_value[k] = r->objective_value[k];
+          store_restore_slot = slot;
+          if (add_individual(r->identity, objective_value) != 0)
+          {
+               free(objective_value);
+               return (1);
+          }
+          get_individual(r->identity)->counter = r->counter;
+     }
+     store_restore_slot = -1;
+     free(objective_value);
+     return (0);
+}
+
+/*-------------------------| store functions |--------------------------*/
+
+int store_open(char *file, int restore)
+/* Maps the archive file and restores or empties it. */
+{
+     store_close();
+
+     store_fd = open(file, O_RDWR | O_CREAT, 0644);
+     if (store_fd == -1)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't open archive file");
+          return (1);
+     }
+
+     /* reserve addresses for the largest file, records never move */
+     store_reserved = STORE_RESERVE;
+     store_base = MAP_FAILED;
+     while (store_base == MAP_FAILED && store_reserved >= ((size_t) 1 << 26))
+     {
+          store_base = mmap(NULL, store_reserved, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_NORESERVE, store_fd, 0);
+          if (store_base == MAP_FAILED)
+               store_reserved /= 2;
+     }
+     if (store_base == MAP_FAILED)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't map archive file");
+          store_base = NULL;
+          close(store_fd);
+          store_fd = -1;
+          return (1);
+     }
+#ifdef MADV_HUGEPAGE
+     madvise(store_base, store_reserved, MADV_HUGEPAGE);
+#endif
+     store_head = (store_header *) store_base;
+     store_enabled = 1;
+
+     if (restore && valid_image())
+          return (restore_image());
+
+     if (ftruncate(store_fd, 0) != 0 || resize_file(1024) != 0)
+     {
+          store_close();
+          return (1);
+     }
+     memcpy(store_head->magic, "FEMOARC1", 8);
+     store_head->objective_size = sizeof(objective_t);
+     store_head->dimension = dimension;
+     store_head->stride = record_stride();
+     store_head->slots = 0;
+     store_head->completed = -1;
+     store_head->selecting = 0;
+     return (0);
+}
+
+
+void store_close(void)
+/* Unmaps and closes the archive file. */
+{
+     if (store_base != NULL)
+     {
+          msync(store_base, STORE_HEADER_SIZE + (size_t) store_capacity
+                * store_head->stride, MS_ASYNC);
+          munmap(store_base, store_reserved);
+     }
+     if (store_fd != -1)
+          close(store_fd);
+     free(store_free_slots);
+     free(store_pending);
+     store_fd = -1;
+     store_base = NULL;
+     store_head = NULL;
+     store_reserved = 0;
+     store_capacity = 0;
+     store_free_slots = NULL;
+     store_pending = NULL;
+     store_free_count = 0;
+     store_pending_count = 0;
+     store_list_capacity = 0;
+     store_restore_slot = -1;
+     store_enabled = 0;
+}
+
+
+objective_t *store_alloc(int *slot)
+/* Allocates a record for a new individual. */
+{
+     store_record *r;
+
+     if (store_restore_slot != -1)
+     {
+          *slot = store_restore_slot;
+          store_restore_slot = -1;
+          return (record(*slot)->objective_value);
+     }
+
+     if (store_free_count > 0)
+          *slot = store_free_slots[--store_free_count];
+     else
+     {
+          if (store_head->slots == store_capacity
+              && resize_file(2 * store_capacity) != 0)
+               return (NULL);
+          *slot = store_head->slots++;
+     }
+
+     store_head->selecting = 1;
+     r = record(*slot);
+     r->identity = -1;
+     r->counter = 0;
+     r->added = store_head->completed + 1;
+     r->removed = -1;
+     return (r->objective_value);
+}
+
+
+void store_bind(int identity)
+/* Stores the identity in the record of the individual. */
+{
+     individual *ind;
+
+     ind = get_individual(identity);
+     if (!store_enabled || ind == NULL || ind->slot == -1)
+          return;
+     record(ind->slot)->identity = identity;
+}
+
+
+void store_release(int slot)
+/* Marks a record as removed in the current generation. */
+{
+     if (!store_enabled || slot == -1)
+          return;
+     record(slot)->removed = store_head->completed + 1;
+     if (push(&store_pending, &store_pending_count, slot) != 0)
+          record(slot)->identity = -1; /* lost until the next restart */
+}
+
+
+void store_counter(int slot, int counter)
+/* Stores the counter of an individual. */
+{
+     if (store_enabled && slot != -1)
+          record(slot)->counter = counter;
+}
+
+
+int store_completed(void)
+/* Returns the last completed generation. */
+{
+     return (store_enabled ? store_head->completed : -1);
+}
+
+
+int store_selecting(void)
+/* Returns 1 if a generation has been started but not completed. */
+{
+     return (store_enabled ? store_head->selecting : 0);
+}
+
+
+int store_complete(void)
+/* Completes the current generation and frees its removed records. */
+{
+     int i;
+
+     if (!store_enabled)
+          return (0);
+
+     store_head->completed++;
+     store_head->selecting = 0;
+     for (i = 0; i < store_pending_count; i++)
+     {
+          record(store_pending[i])->identity = -1;
+          push(&store_free_slots, &store_free_count, store_pending[i]);
+     }
+     store_pending_count = 0;
+     msync(store_base, STORE_HEADER_SIZE + (size_t) store_head->slots
+           * store_head->stride, MS_ASYNC);
+     return (0);
+}
+
+#endif /* PISA_UNIX */
+
+
+#ifdef PISA_WIN
+
+/* memory-mapped archives are not supported on Windows */
+
+int store_open(char *file, int restore)
+{
+     log_to_file(log_file, __FILE__, __LINE__,
+                 "archive files are not supported on this platform");
+     return (1);
+}
+
+
+void store_close(void)
+{
+}
+
+
+objective_t *store_alloc(int *slot)
+{
+     return (NULL);
+}
+
+
+void store_bind(int identity)
+{
+}
+
+
+void store_release(int slot)
+{
+}
+
+
+void store_counter(int slot, int counter)
+{
+}
+
+
+int store_completed(void)
+{
+     return (-1);
+}
+
+
+int store_selecting(void)
+{
+     return (0);
+}
+
+
+int store_complete(void)
+{
+     return (0);
+}
+
+#endif /* PISA_WIN */
@@ -0,0 +1,85 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  File-backed storage of the individuals.
+
+  The objective values, the counter and the identity of every
+  individual are kept in one record of a memory-mapped file. A large
+  range of addresses is reserved when the file is opened, so records
+  never move while the file grows and the operating system can page
+  out parts of an archive that does not fit into memory.
+
+  Each record also remembers the generation in which it was added and
+  removed. When FEMO is restarted after a crash, the archive is
+  restored as it was at the end of the last completed generation.
+
+  Header file.
+
+  file: femo_store.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_STORE_H
+#define FEMO_STORE_H
+
+#include "selector_user.h"
+
+/* addresses reserved for the mapping (at most, less if not available) */
+#define STORE_RESERVE ((size_t) 1 << 40)
+
+/* bytes before the first record */
+#define STORE_HEADER_SIZE 4096
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int store_enabled; /* 1 while an archive file is open */
+
+/*-------------------------| functions |--------------------------------*/
+
+int store_open(char *file, int restore);
+/* Opens the archive file 'file'. If 'restore' is 1 and the file holds
+   a valid image for 'dimension' objectives, the individuals of the
+   last completed generation are added to the global population again,
+   otherwise the file is emptied.
+   Returns 0 if successful and 1 otherwise. */
+
+void store_close(void);
+/* Unmaps and closes the archive file. Individuals still pointing into
+   it must not be used anymore (only freed). */
+
+objective_t *store_alloc(int *slot);
+/* Allocates a record for a new individual, stores its number in
+   '*slot' and returns its objective values, NULL if out of space. */
+
+void store_bind(int identity);
+/* Stores the identity of the individual 'identity' in its record, so
+   it is part of the image once the generation is completed. */
+
+void store_release(int slot);
+/* Marks a record as removed. It is reused after the generation has
+   been completed. Does nothing if no file is open. */
+
+void store_counter(int slot, int counter);
+/* Stores the counter of an individual in its record. */
+
+int store_completed(void);
+/* Returns the last completed generation, -1 if there is none. */
+
+int store_selecting(void);
+/* Returns 1 if records have been allocated since the last completed
+   generation, i.e. a selection was interrupted, and 0 otherwise. */
+
+int store_complete(void);
+/* Marks the current generation as completed. Called after all files
+   of a selection have been written. Returns 0. */
+
+#endif /* FEMO_STORE_H */
@@ -0,0 +1,282 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Timeline tracing of the selector.
+
+  Recording a span only touches the buffer of the calling thread, so
+  no locks are taken on the fast path. A buffer is written to the
+  trace file (under a mutex) when it is full or when the trace is
+  closed.
+
+  C file.
+
+  file: femo_trace.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_trace.h"
+
+#ifdef PISA_UNIX
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/*--------------------| global variable definitions |-------------------*/
+
+int trace_enabled = 0; /* 1 while a trace file is open */
+
+#ifdef PISA_UNIX
+
+/* one recorded span */
+typedef struct trace_event_t
+{
+     const char *name;
+     const char *category;
+     double begin;    /* microseconds */
+     double duration; /* microseconds */
+} trace_event;
+
+/* spans recorded by one thread */
+typedef struct trace_buffer_t
+{
+     trace_event events[TRACE_BUFFER_EVENTS];
+     int count;       /* number of buffered events */
+     int thread_id;   /* 'tid' in the trace, 1 for the first thread */
+     int named;       /* 1 after the thread name has been written */
+     struct trace_buffer_t *next; /* next buffer in 'trace_buffers' */
+} trace_buffer;
+
+/* only used in this file */
+
+static FILE *trace_fp = NULL;
+
+static pthread_mutex_t trace_file_lock = PTHREAD_MUTEX_INITIALIZER;
+/* serializes writes to 'trace_fp' */
+
+static int trace_events_written = 0;
+/* number of JSON objects in the file, protected by 'trace_file_lock' */
+
+static _Atomic(trace_buffer *) trace_buffers = NULL;
+/* list of the buffers of all threads that ever recorded a span */
+
+static atomic_int trace_threads = 0;
+/* number of buffers in 'trace_buffers' */
+
+static _Thread_local trace_buffer *local_buffer = NULL;
+/* buffer of the calling thread */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static trace_buffer *register_buffer(void)
+/* Allocates the buffer of the calling thread and pushes it onto
+   'trace_buffers'. Returns NULL if out of memory. */
+{
+     trace_buffer *buffer;
+     trace_buffer *head;
+
+     buffer = (trace_buffer *) malloc(sizeof(trace_buffer));
+     if (buffer == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (NULL);
+     }
+     buffer->count = 0;
+     buffer->named = 0;
+     buffer->thread_id = atomic_fetch_add(&trace_threads, 1) + 1;
+
+     head = atomic_load(&trace_buffers);
+     do
+          buffer->next = head;
+     while (!atomic_compare_exchange_weak(&trace_buffers, &head, buffer));
+
+     local_buffer = buffer;
+     return (buffer);
+}
+
+
+static void write_separator(void)
+/* Separates JSON objects in the event array. Caller holds the lock. */
+{
+     if (trace_events_written > 0)
+          fprintf(trace_fp, ",\n");
+     trace_events_written++;
+}
+
+
+static void flush_buffer(trace_buffer *buffer)
+/* Writes all events of 'buffer' to the trace file and empties it. */
+{
+     int i;
+     int pid;
+     trace_event *event;
+
+     pid = (int) getpid();
+     pthread_mutex_lock(&trace_file_lock);
+     if (trace_fp != NULL)
+     {
+          if (!buffer->named)
+          {
+               write_separator();
+               fprintf(trace_fp, "{\"name\":\"thread_name\",\"ph\":\"M\","
+                       "\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                       pid, buffer->thread_id,
+                       buffer->thread_id == 1 ? "selector" : "worker");
+               buffer->named = 1;
+          }
+          for (i = 0; i < buffer->count; i++)
+          {
+               event = &buffer->events[i];
+               write_separator();
+               fprintf(trace_fp, "{\"name\":\"%s\",\"cat\":\"%s\","
+                       "\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                       "\"pid\":%d,\"tid\":%d}",
+                       event->name, event->category, event->begin,
+                       event->duration, pid, buffer->thread_id);
+          }
+     }
+     pthread_mutex_unlock(&trace_file_lock);
+     buffer->count = 0;
+}
+
+/*-------------------------| trace functions |--------------------------*/
+
+int trace_open(char *file)
+/* Starts writing a trace to 'file'. */
+{
+     if (trace_enabled)
+          return (0);
+
+     trace_fp = fopen(file, "w");
+     if (trace_fp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't open trace file");
+          return (1);
+     }
+     fprintf(trace_fp, "[\n");
+     trace_events_written = 0;
+     trace_enabled = 1;
+     return (0);
+}
+
+
+double trace_begin(void)
+/* Returns the current time stamp in microseconds. */
+{
+     struct timespec now;
+
+     clock_gettime(CLOCK_MONOTONIC, &now);
+     return (now.tv_sec * 1e6 + now.tv_nsec * 1e-3);
+}
+
+
+void trace_end(const char *name, const char *category, double begin)
+/* Records a span from 'begin' until now in the calling thread's
+   buffer. */
+{
+     trace_buffer *buffer;
+     trace_event *event;
+     double now;
+
+     if (!trace_enabled)
+          return;
+
+     buffer = local_buffer;
+     if (buffer == NULL)
+     {
+          buffer = register_buffer();
+          if (buffer == NULL)
+               return;
+     }
+
+     now = trace_begin();
+     event = &buffer->events[buffer->count];
+     event->name = name;
+     event->category = category;
+     event->begin = begin;
+     event->duration = now - begin;
+     buffer->count++;
+
+     if (buffer->count == TRACE_BUFFER_EVENTS)
+          flush_buffer(buffer);
+}
+
+
+int trace_close(void)
+/* Writes out and frees the buffers of all threads and closes the trace
+   file. The other threads have ended by now, so only the buffer of
+   the calling thread is still referenced. */
+{
+     trace_buffer *buffer;
+     trace_buffer *next;
+
+     if (!trace_enabled)
+          return (0);
+
+     for (buffer = atomic_load(&trace_buffers); buffer != NULL;
+          buffer = next)
+     {
+          next = buffer->next;
+          flush_buffer(buffer);
+          free(buffer);
+     }
+     atomic_store(&trace_buffers, NULL);
+     atomic_store(&trace_threads, 0);
+     local_buffer = NULL;
+
+     trace_enabled = 0;
+     fprintf(trace_fp, "\n]\n");
+     fclose(trace_fp);
+     trace_fp = NULL;
+     return (0);
+}
+
+#endif /* PISA_UNIX */
+
+
+#ifdef PISA_WIN
+
+/* tracing is not supported on Windows, all functions are no-ops */
+
+int trace_open(char *file)
+{
+     log_to_file(log_file, __FILE__, __LINE__,
+                 "tracing is not supported on this platform");
+     return (1);
+}
+
+
+double trace_begin(void)
+{
+     return (0);
+}
+
+
+void trace_end(const char *name, const char *category, double begin)
+{
+}
+
+
+int trace_close(void)
+{
+     return (0);
+}
+
+#endif /* PISA_WIN */
@@ -0,0 +1,56 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Timeline tracing of the selector. Spans are collected in per-thread
+  buffers and written as Chrome trace-event JSON, which can be opened
+  in chrome://tracing or ui.perfetto.dev.
+
+  Header file.
+
+  file: femo_trace.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_TRACE_H
+#define FEMO_TRACE_H
+
+/*-------------------------| constants |--------------------------------*/
+
+#define TRACE_BUFFER_EVENTS 8192
+/* number of spans a thread buffers before it writes them out */
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int trace_enabled; /* 1 while a trace file is open */
+
+/*-------------------------| functions |--------------------------------*/
+
+int trace_open(char *file);
+/* Starts writing a trace to 'file'. Calling it again while a trace
+   is open does nothing.
+   Returns 0 if successful and 1 otherwise. */
+
+double trace_begin(void);
+/* Returns the current time stamp in microseconds, to be passed to
+   trace_end() when the span is over. */
+
+void trace_end(const char *name, const char *category, double begin);
+/* Records a span called 'name' that started at 'begin' and ends
+   now. 'name' and 'category' must be string literals (only the
+   pointers are stored). Does nothing if tracing is disabled. */
+
+int trace_close(void);
+/* Writes out the buffers of all threads and closes the trace file.
+   Must only be called when no other thread is recording spans.
+   Returns 0 if successful and 1 otherwise. */
+
+#endif /* FEMO_TRACE_H */
@@ -0,0 +1,374 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Ordered set of (key, identity) pairs (treap with subtree sizes).
+
+  C file.
+
+  file: femo_tree.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_tree.h"
+
+/*-------------------------| helper functions |-------------------------*/
+
+static int pair_less(double key_a, int id_a, double key_b, int id_b)
+/* Returns 1 if (key_a, id_a) is smaller than (key_b, id_b). */
+{
+     return (key_a < key_b || (key_a == key_b && id_a < id_b));
+}
+
+
+static int node_size(tree *t, int n)
+{
+     return (n == -1 ? 0 : t->nodes[n].size);
+}
+
+
+static void update_size(tree *t, int n)
+{
+     t->nodes[n].size = 1 + node_size(t, t->nodes[n].left)
+          + node_size(t, t->nodes[n].right);
+}
+
+
+static unsigned int next_priority(tree *t)
+/* xorshift generator, does not touch the state of rand() */
+{
+     t->seed ^= t->seed << 13;
+     t->seed ^= t->seed >> 17;
+     t->seed ^= t->seed << 5;
+     return (t->seed);
+}
+
+
+static int grow_nodes(tree *t, int capacity)
+/* Makes the node storage hold 'capacity' nodes.
+   Returns 0 if successful and 1 if out of memory. */
+{
+     tree_node *tmp;
+
+     tmp = (tree_node *) realloc(t->nodes, capacity * sizeof(tree_node));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     t->nodes = tmp;
+     t->capacity = capacity;
+     return (0);
+}
+
+
+static int new_node(tree *t, double key, int identity)
+/* Returns the index of an unused node, -1 if out of memory. */
+{
+     int n;
+
+     if (t->free_node != -1)
+     {
+          n = t->free_node;
+          t->free_node = t->nodes[n].left;
+     }
+     else
+     {
+          if (t->used == t->capacity
+              && grow_nodes(t, t->capacity == 0 ? 64 : t->capacity * 2) != 0)
+               return (-1);
+          n = t->used;
+          t->used++;
+     }
+
+     t->nodes[n].key = key;
+     t->nodes[n].identity = identity;
+     t->nodes[n].priority = next_priority(t);
+     t->nodes[n].left = -1;
+     t->nodes[n].right = -1;
+     t->nodes[n].size = 1;
+     return (n);
+}
+
+
+static void split(tree *t, int n, double key, int identity, int inclusive,
+                  int *left, int *right)
+/* Splits the subtree 'n' into the pairs smaller than (key, identity)
+   and the others. If 'inclusive' is set, (key, identity) itself goes
+   to the left part. */
+{
+     int goes_left;
+
+     if (n == -1)
+     {
+          *left = -1;
+          *right = -1;
+          return;
+     }
+
+     if (inclusive)
+          goes_left = !pair_less(key, identity, t->nodes[n].key,
+                                 t->nodes[n].identity);
+     else
+          goes_left = pair_less(t->nodes[n].key, t->nodes[n].identity,
+                                key, identity);
+
+     if (goes_left)
+     {
+          split(t, t->nodes[n].right, key, identity, inclusive,
+                &t->nodes[n].right, right);
+          *left = n;
+     }
+     else
+     {
+          split(t, t->nodes[n].left, key, identity, inclusive,
+                left, &t->nodes[n].left);
+          *right = n;
+     }
+     update_size(t, n);
+}
+
+
+static int merge(tree *t, int left, int right)
+/* Merges two subtrees, all pairs in 'left' are smaller than those in
+   'right'. Returns the root of the merged subtree. */
+{
+     if (left == -1)
+          return (right);
+     if (right == -1)
+          return (left);
+
+     if (t->nodes[left].priority > t->nodes[right].priority)
+     {
+          t->nodes[left].right = merge(t, t->nodes[left].right, right);
+          update_size(t, left);
+          return (left);
+     }
+     else
+     {
+          t->nodes[right].left = merge(t, left, t->nodes[right].left);
+          update_size(t, right);
+          return (right);
+     }
+}
+
+/*-------------------------| tree functions |---------------------------*/
+
+void tree_init(tree *t)
+/* Initializes an empty tree without allocating memory. */
+{
+     t->nodes = NULL;
+     t->capacity = 0;
+     t->used = 0;
+     t->free_node = -1;
+     t->root = -1;
+     t->seed = 2463534242u;
+}
+
+
+void tree_clear(tree *t)
+/* Removes all pairs but keeps the node storage. */
+{
+     t->used = 0;
+     t->free_node = -1;
+     t->root = -1;
+}
+
+
+void tree_free(tree *t)
+/* Frees the node storage. */
+{
+     free(t->nodes);
+     tree_init(t);
+}
+
+
+int tree_reserve(tree *t, int count)
+/* Makes room for 'count' pairs. */
+{
+     if (count <= t->capacity)
+          return (0);
+     return (grow_nodes(t, count));
+}
+
+
+int tree_size(tree *t)
+{
+     return (node_size(t, t->root));
+}
+
+
+int tree_insert(tree *t, double key, int identity)
+/* Inserts the pair (key, identity). */
+{
+     int n, left, right;
+
+     n = new_node(t, key, identity);
+     if (n == -1)
+          return (1);
+
+     split(t, t->root, key, identity, 0, &left, &right);
+     t->root = merge(t, merge(t, left, n), right);
+     return (0);
+}
+
+
+int tree_remove(tree *t, double key, int identity)
+/* Removes the pair (key, identity). */
+{
+     int left, middle, right;
+
+     split(t, t->root, key, identity, 0, &left, &right);
+     split(t, right, key, identity, 1, &middle, &right);
+
+     if (middle != -1)
+     {
+          /* 'middle' is exactly the pair, put the node on the free list */
+          t->nodes[middle].left = t->free_node;
+          t->free_node = middle;
+     }
+     t->root = merge(t, left, right);
+     return (middle == -1);
+}
+
+
+int tree_find(tree *t, double key, int identity)
+/* Returns the node of the pair (key, identity). */
+{
+     int n = t->root;
+
+     while (n != -1)
+     {
+          if (pair_less(key, identity, t->nodes[n].key, t->nodes[n].identity))
+               n = t->nodes[n].left;
+          else if (pair_less(t->nodes[n].key, t->nodes[n].identity,
+                             key, identity))
+               n = t->nodes[n].right;
+          else
+               return (n);
+     }
+     return (-1);
+}
+
+
+int tree_first(tree *t)
+{
+     int n = t->root;
+
+     if (n == -1)
+          return (-1);
+     while (t->nodes[n].left != -1)
+          n = t->nodes[n].left;
+     return (n);
+}
+
+
+int tree_last(tree *t)
+{
+     int n = t->root;
+
+     if (n == -1)
+          return (-1);
+     while (t->nodes[n].right != -1)
+          n = t->nodes[n].right;
+     return (n);
+}
+
+
+int tree_lower(tree *t, double key, int identity)
+/* Returns the node of the largest pair smaller than (key, identity). */
+{
+     int n = t->root;
+     int found = -1;
+
+     while (n != -1)
+     {
+          if (pair_less(t->nodes[n].key, t->nodes[n].identity, key, identity))
+          {
+               found = n;
+               n = t->nodes[n].right;
+          }
+          else
+               n = t->nodes[n].left;
+     }
+     return (found);
+}
+
+
+int tree_higher(tree *t, double key, int identity)
+/* Returns the node of the smallest pair larger than (key, identity). */
+{
+     int n = t->root;
+     int found = -1;
+
+     while (n != -1)
+     {
+          if (pair_less(key, identity, t->nodes[n].key, t->nodes[n].identity))
+          {
+               found = n;
+               n = t->nodes[n].left;
+          }
+          else
+               n = t->nodes[n].right;
+     }
+     return (found);
+}
+
+
+int tree_rank(tree *t, double key, int identity)
+/* Returns the number of pairs smaller than (key, identity). */
+{
+     int n = t->root;
+     int rank = 0;
+
+     while (n != -1)
+     {
+          if (pair_less(t->nodes[n].key, t->nodes[n].identity, key, identity))
+          {
+               rank += node_size(t, t->nodes[n].left) + 1;
+               n = t->nodes[n].right;
+          }
+          else
+               n = t->nodes[n].left;
+     }
+     return (rank);
+}
+
+
+int tree_select(tree *t, int rank)
+/* Returns the node with 'rank' smaller pairs. */
+{
+     int n = t->root;
+     int left_size;
+
+     if (rank < 0 || rank >= node_size(t, n))
+          return (-1);
+
+     while (n != -1)
+     {
+          left_size = node_size(t, t->nodes[n].left);
+          if (rank < left_size)
+               n = t->nodes[n].left;
+          else if (rank == left_size)
+               return (n);
+          else
+          {
+               rank -= left_size + 1;
+               n = t->nodes[n].right;
+          }
+     }
+     return (-1);
+}
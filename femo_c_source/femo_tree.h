@@ -0,0 +1,105 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Ordered set of (key, identity) pairs, implemented as a treap with
+  subtree sizes. All operations take expected O(log n) time. Nodes
+  are kept in one array and are reused, so a tree that has reached its
+  working size does not allocate any more.
+
+  Header file.
+
+  file: femo_tree.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_TREE_H
+#define FEMO_TREE_H
+
+/*-------------------------| tree |-------------------------------------*/
+
+typedef struct tree_node_t
+{
+     double key;
+     int identity;
+     unsigned int priority;
+     int left;   /* index of left child, -1 if none */
+     int right;  /* index of right child, -1 if none */
+     int size;   /* number of nodes in this subtree */
+} tree_node;
+
+/* Pairs are ordered by key, ties are broken by identity. */
+typedef struct tree_t
+{
+     tree_node *nodes; /* node storage */
+     int capacity;     /* number of allocated nodes */
+     int used;         /* nodes [0, used) have been handed out */
+     int free_node;    /* first unused node below 'used', -1 if none */
+     int root;         /* -1 if the tree is empty */
+     unsigned int seed; /* state for the node priorities */
+} tree;
+
+/* key and identity of node 'n' */
+#define TREE_KEY(t, n) ((t)->nodes[(n)].key)
+#define TREE_IDENTITY(t, n) ((t)->nodes[(n)].identity)
+
+/*-------------------------| functions |--------------------------------*/
+
+void tree_init(tree *t);
+/* Initializes an empty tree without allocating memory. */
+
+void tree_clear(tree *t);
+/* Removes all pairs but keeps the node storage. */
+
+void tree_free(tree *t);
+/* Frees the node storage. The tree is empty afterwards. */
+
+int tree_reserve(tree *t, int count);
+/* Makes room for 'count' pairs, so that inserting up to 'count' pairs
+   allocates nothing. Returns 0 if successful and 1 if out of memory. */
+
+int tree_size(tree *t);
+/* Returns the number of pairs in the tree. */
+
+int tree_insert(tree *t, double key, int identity);
+/* Inserts the pair (key, identity).
+   Returns 0 if successful and 1 if out of memory. */
+
+int tree_remove(tree *t, double key, int identity);
+/* Removes the pair (key, identity).
+   Returns 0 if successful and 1 if the pair is not in the tree. */
+
+int tree_find(tree *t, double key, int identity);
+/* Returns the node of the pair (key, identity), -1 if it is not in
+   the tree. */
+
+int tree_first(tree *t);
+/* Returns the node of the smallest pair, -1 if the tree is empty. */
+
+int tree_last(tree *t);
+/* Returns the node of the largest pair, -1 if the tree is empty. */
+
+int tree_lower(tree *t, double key, int identity);
+/* Returns the node of the largest pair smaller than (key, identity),
+   -1 if there is none. */
+
+int tree_higher(tree *t, double key, int identity);
+/* Returns the node of the smallest pair larger than (key, identity),
+   -1 if there is none. */
+
+int tree_rank(tree *t, double key, int identity);
+/* Returns the number of pairs smaller than (key, identity). */
+
+int tree_select(tree *t, int rank);
+/* Returns the node of the pair with 'rank' smaller pairs,
+   -1 if rank is out of range. */
+
+#endif /* FEMO_TREE_H */
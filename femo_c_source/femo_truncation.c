@@ -0,0 +1,478 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Contributions of the archive members for truncation.
+
+  Adding or removing a member only changes the contributions of its
+  neighbours, which are recomputed immediately. The crowding distance
+  is normalized by the range of each objective, so if a boundary
+  member changes, all contributions are recomputed (in linear time)
+  the next time the worst member is asked for.
+
+  C file.
+
+  file: femo_truncation.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "selector.h"
+#include "selector_user.h"
+#include "femo_tree.h"
+#include "femo_truncation.h"
+
+/*--------------------| global variable definitions |-------------------*/
+
+int truncation_enabled = 0; /* 1 after truncation_init() */
+
+/* only used in this file */
+
+static tree *trunc_trees = NULL;
+/* members sorted by each objective (only the first for two objectives) */
+
+static int trunc_tree_count = 0; /* number of trees */
+
+static double *trunc_range = NULL;
+/* range of each objective the contributions have been computed with */
+
+static double *trunc_value = NULL; /* contribution, indexed by handle */
+
+static int *trunc_position = NULL;
+/* position in 'trunc_heap', -1 for non-members, indexed by handle */
+
+static int trunc_slots = 0; /* length of 'trunc_value' and 'trunc_position' */
+
+static int *trunc_heap = NULL; /* members, smallest contribution first */
+
+static int trunc_count = 0; /* number of members */
+
+static int trunc_heap_capacity = 0;
+
+static int *trunc_neighbours = NULL; /* 2 per tree, used by remove */
+
+static int trunc_dirty = 0; /* 1 if all contributions are outdated */
+
+/* contribution and heap position of a member */
+#define VALUE(identity) (trunc_value[get_individual(identity)->handle])
+#define POSITION(identity) (trunc_position[get_individual(identity)->handle])
+
+/*-------------------------| helper functions |-------------------------*/
+
+static int heap_less(int a, int b)
+/* Returns 1 if member 'a' has to be evicted before member 'b'. */
+{
+     return (VALUE(a) < VALUE(b)
+             || (VALUE(a) == VALUE(b) && a < b));
+}
+
+
+static void heap_place(int position, int identity)
+{
+     trunc_heap[position] = identity;
+     POSITION(identity) = position;
+}
+
+
+static void sift_up(int position)
+{
+     int identity, parent;
+
+     identity = trunc_heap[position];
+     while (position > 0)
+     {
+          parent = (position - 1) / 2;
+          if (!heap_less(identity, trunc_heap[parent]))
+               break;
+          heap_place(position, trunc_heap[parent]);
+          position = parent;
+     }
+     heap_place(position, identity);
+}
+
+
+static void sift_down(int position)
+{
+     int identity, child;
+
+     identity = trunc_heap[position];
+     for (;;)
+     {
+          child = 2 * position + 1;
+          if (child >= trunc_count)
+               break;
+          if (child + 1 < trunc_count
+              && heap_less(trunc_heap[child + 1], trunc_heap[child]))
+               child++;
+          if (!heap_less(trunc_heap[child], identity))
+               break;
+          heap_place(position, trunc_heap[child]);
+          position = child;
+     }
+     heap_place(position, identity);
+}
+
+
+static int ensure_slots(int count)
+/* Makes room for 'count' handles in the arrays indexed by handle.
+   Returns 0 if successful and 1 if out of memory. */
+{
+     int i, new_slots;
+     double *tmp_value;
+     int *tmp_position;
+
+     if (count <= trunc_slots)
+          return (0);
+
+     new_slots = trunc_slots == 0 ? 1024 : trunc_slots;
+     while (new_slots < count)
+          new_slots *= 2;
+
+     tmp_value = (double *) realloc(trunc_value, new_slots * sizeof(double));
+     if (tmp_value == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     trunc_value = tmp_value;
+     tmp_position = (int *) realloc(trunc_position, new_slots * sizeof(int));
+     if (tmp_position == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     trunc_position = tmp_position;
+
+     for (i = trunc_slots; i < new_slots; i++)
+          trunc_position[i] = -1;
+     trunc_slots = new_slots;
+     return (0);
+}
+
+
+static int grow_heap(int capacity)
+/* Makes room for 'capacity' members in the heap.
+   Returns 0 if successful and 1 if out of memory. */
+{
+     int *tmp;
+
+     tmp = (int *) realloc(trunc_heap, capacity * sizeof(int));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     trunc_heap = tmp;
+     trunc_heap_capacity = capacity;
+     return (0);
+}
+
+
+static double contribution(int identity)
+/* Computes the contribution of a member from its neighbours. */
+{
+     int k, prev, next;
+     double value, distance;
+
+     if (dimension == 2)
+     {
+          value = get_objective_value(identity, 0);
+          prev = tree_lower(&trunc_trees[0], value, identity);
+          next = tree_higher(&trunc_trees[0], value, identity);
+          if (prev == -1 || next == -1)
+               return (HUGE_VAL);
+          return ((TREE_KEY(&trunc_trees[0], next) - value)
+                  * (get_objective_value(TREE_IDENTITY(&trunc_trees[0], prev),
+                                         1)
+                     - get_objective_value(identity, 1)));
+     }
+
+     distance = 0;
+     for (k = 0; k < trunc_tree_count; k++)
+     {
+          value = get_objective_value(identity, k);
+          prev = tree_lower(&trunc_trees[k], value, identity);
+          next = tree_higher(&trunc_trees[k], value, identity);
+          if (prev == -1 || next == -1)
+               return (HUGE_VAL);
+          if (trunc_range[k] > 0)
+               distance += (TREE_KEY(&trunc_trees[k], next)
+                            - TREE_KEY(&trunc_trees[k], prev))
+                    / trunc_range[k];
+     }
+     return (distance);
+}
+
+
+static void refresh(int identity)
+/* Recomputes the contribution of a member and restores the heap. */
+{
+     int position;
+
+     position = POSITION(identity);
+     VALUE(identity) = contribution(identity);
+     sift_up(position);
+     sift_down(POSITION(identity));
+}
+
+
+static void check_ranges(void)
+/* Marks all contributions as outdated if the range of an objective
+   has changed (only for the crowding distance). */
+{
+     int k, first, last;
+     double range;
+
+     if (dimension == 2)
+          return;
+
+     for (k = 0; k < trunc_tree_count; k++)
+     {
+          first = tree_first(&trunc_trees[k]);
+          last = tree_last(&trunc_trees[k]);
+          range = first == -1 ? 0 : TREE_KEY(&trunc_trees[k], last)
+               - TREE_KEY(&trunc_trees[k], first);
+          if (range != trunc_range[k])
+          {
+               trunc_range[k] = range;
+               trunc_dirty = 1;
+          }
+     }
+}
+
+
+static void refresh_neighbours(int identity, int *neighbours)
+/* Stores the neighbours of 'identity' in every tree in 'neighbours'
+   (-1 where there is none) if 'neighbours' is not NULL, otherwise
+   refreshes their contributions. */
+{
+     int k, n;
+     double value;
+
+     for (k = 0; k < trunc_tree_count; k++)
+     {
+          value = get_objective_value(identity, k);
+
+          n = tree_lower(&trunc_trees[k], value, identity);
+          n = n == -1 ? -1 : TREE_IDENTITY(&trunc_trees[k], n);
+          if (neighbours != NULL)
+               neighbours[2 * k] = n;
+          else if (n != -1)
+               refresh(n);
+
+          n = tree_higher(&trunc_trees[k], value, identity);
+          n = n == -1 ? -1 : TREE_IDENTITY(&trunc_trees[k], n);
+          if (neighbours != NULL)
+               neighbours[2 * k + 1] = n;
+          else if (n != -1)
+               refresh(n);
+     }
+}
+
+/*-------------------------| truncation functions |---------------------*/
+
+int truncation_init(void)
+/* Prepares the bookkeeping for 'dimension' objectives. */
+{
+     int k;
+
+     truncation_free();
+
+     trunc_tree_count = dimension == 2 ? 1 : dimension;
+     trunc_trees = (tree *) malloc(trunc_tree_count * sizeof(tree));
+     trunc_range = (double *) malloc(trunc_tree_count * sizeof(double));
+     trunc_neighbours = (int *) malloc(2 * trunc_tree_count * sizeof(int));
+     if (trunc_trees == NULL || trunc_range == NULL
+         || trunc_neighbours == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          free(trunc_trees);
+          free(trunc_range);
+          free(trunc_neighbours);
+          trunc_trees = NULL;
+          trunc_range = NULL;
+          trunc_neighbours = NULL;
+          return (1);
+     }
+     for (k = 0; k < trunc_tree_count; k++)
+     {
+          tree_init(&trunc_trees[k]);
+          trunc_range[k] = 0;
+     }
+     truncation_enabled = 1;
+     return (0);
+}
+
+
+void truncation_clear(void)
+/* Removes all members. */
+{
+     int i, k;
+
+     if (!truncation_enabled)
+          return;
+
+     for (i = 0; i < trunc_slots; i++)
+          trunc_position[i] = -1;
+     trunc_count = 0;
+     for (k = 0; k < trunc_tree_count; k++)
+     {
+          tree_clear(&trunc_trees[k]);
+          trunc_range[k] = 0;
+     }
+     trunc_dirty = 0;
+}
+
+
+void truncation_free(void)
+/* Frees all memory. */
+{
+     int k;
+
+     if (trunc_trees != NULL)
+     {
+          for (k = 0; k < trunc_tree_count; k++)
+               tree_free(&trunc_trees[k]);
+     }
+     free(trunc_trees);
+     free(trunc_range);
+     free(trunc_value);
+     free(trunc_position);
+     free(trunc_heap);
+     free(trunc_neighbours);
+     trunc_trees = NULL;
+     trunc_range = NULL;
+     trunc_value = NULL;
+     trunc_position = NULL;
+     trunc_heap = NULL;
+     trunc_neighbours = NULL;
+     trunc_tree_count = 0;
+     trunc_slots = 0;
+     trunc_count = 0;
+     trunc_heap_capacity = 0;
+     trunc_dirty = 0;
+     truncation_enabled = 0;
+}
+
+
+int truncation_reserve(int count)
+/* Makes room for 'count' members. */
+{
+     int k;
+
+     if (!truncation_enabled)
+          return (0);
+
+     if (ensure_slots(count) != 0
+         || (count > trunc_heap_capacity && grow_heap(count) != 0))
+          return (1);
+     for (k = 0; k < trunc_tree_count; k++)
+     {
+          if (tree_reserve(&trunc_trees[k], count) != 0)
+               return (1);
+     }
+     return (0);
+}
+
+
+int truncation_insert(int identity)
+/* Adds the archive member 'identity'. */
+{
+     int k;
+
+     if (!truncation_enabled)
+          return (0);
+
+     if (ensure_slots(get_handle(identity) + 1) != 0
+         || (trunc_count == trunc_heap_capacity
+             && grow_heap(trunc_heap_capacity == 0 ? 1024
+                          : trunc_heap_capacity * 2) != 0))
+          return (1);
+
+     for (k = 0; k < trunc_tree_count; k++)
+     {
+          if (tree_insert(&trunc_trees[k], get_objective_value(identity, k),
+                          identity) != 0)
+               return (1);
+     }
+     check_ranges();
+
+     VALUE(identity) = trunc_dirty ? 0 : contribution(identity);
+     trunc_heap[trunc_count] = identity;
+     POSITION(identity) = trunc_count;
+     trunc_count++;
+     sift_up(trunc_count - 1);
+
+     if (!trunc_dirty)
+          refresh_neighbours(identity, NULL);
+     return (0);
+}
+
+
+int truncation_remove(int identity)
+/* Removes the archive member 'identity'. */
+{
+     int k, position, last, handle;
+
+     handle = get_handle(identity);
+     if (!truncation_enabled || handle < 0 || handle >= trunc_slots
+         || trunc_position[handle] == -1)
+          return (0);
+
+     refresh_neighbours(identity, trunc_neighbours);
+     for (k = 0; k < trunc_tree_count; k++)
+          tree_remove(&trunc_trees[k], get_objective_value(identity, k),
+                      identity);
+
+     /* move the last heap entry into the gap */
+     position = POSITION(identity);
+     POSITION(identity) = -1;
+     trunc_count--;
+     if (position != trunc_count)
+     {
+          last = trunc_heap[trunc_count];
+          heap_place(position, last);
+          sift_up(position);
+          sift_down(POSITION(last));
+     }
+
+     check_ranges();
+     if (!trunc_dirty)
+     {
+          for (k = 0; k < 2 * trunc_tree_count; k++)
+               if (trunc_neighbours[k] != -1)
+                    refresh(trunc_neighbours[k]);
+     }
+     return (0);
+}
+
+
+int truncation_worst(void)
+/* Returns the member with the smallest contribution. */
+{
+     int i;
+
+     if (trunc_count == 0)
+          return (-1);
+
+     if (trunc_dirty)
+     {
+          for (i = 0; i < trunc_count; i++)
+               VALUE(trunc_heap[i]) = contribution(trunc_heap[i]);
+          for (i = trunc_count / 2 - 1; i >= 0; i--)
+               sift_down(i);
+          trunc_dirty = 0;
+     }
+     return (trunc_heap[0]);
+}
@@ -0,0 +1,71 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Contributions of the archive members, used to truncate an archive
+  of bounded size.
+
+  For two objectives the contribution of a member is the area it
+  dominates exclusively, bounded by its two neighbours in the front.
+  For three and more objectives it is the crowding distance (sum of
+  the normalized distances between the neighbours along each
+  objective). Members at the boundary of the front have an infinite
+  contribution.
+
+  The members are kept in one tree per objective, so the neighbours of
+  an added or removed member are found in O(log n), and in a heap
+  ordered by contribution, so the member with the smallest
+  contribution is found in O(1).
+
+  Header file.
+
+  file: femo_truncation.h
+  last change: $date$
+
+  ========================================================================
+*/
+
+#ifndef FEMO_TRUNCATION_H
+#define FEMO_TRUNCATION_H
+
+/*---------------| declaration of global variables |-------------------*/
+
+extern int truncation_enabled; /* 1 after truncation_init() */
+
+/*-------------------------| functions |--------------------------------*/
+
+int truncation_init(void);
+/* Prepares the bookkeeping for 'dimension' objectives and empties it.
+   Returns 0 if successful and 1 otherwise. */
+
+void truncation_clear(void);
+/* Removes all members. */
+
+void truncation_free(void);
+/* Frees all memory, truncation_enabled is 0 afterwards. */
+
+int truncation_reserve(int count);
+/* Makes room for 'count' members with handles below 'count', so that
+   adding members allocates nothing below it.
+   Returns 0 if successful and 1 otherwise. */
+
+int truncation_insert(int identity);
+/* Adds the archive member 'identity'.
+   Returns 0 if successful and 1 otherwise. */
+
+int truncation_remove(int identity);
+/* Removes the archive member 'identity'. It has to be called while the
+   individual still exists. Does nothing if it is not a member.
+   Returns 0 if successful and 1 otherwise. */
+
+int truncation_worst(void);
+/* Returns the member with the smallest contribution (ties are broken
+   by the smaller identity), -1 if there is none. */
+
+#endif /* FEMO_TRUNCATION_H */
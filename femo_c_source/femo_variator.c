@@ -0,0 +1,345 @@
+/*========================================================================
+  PISA  (www.tik.ee.ethz.ch/pisa/)
+
+  ========================================================================
+  Computer Engineering (TIK)
+  ETH Zurich
+
+  ========================================================================
+  FEMO - Fair Evolutionary Multiobjective Optimizer
+
+  Scripted variator for the allocation check ('make check') and the
+  check of femo_mpi ('make check_mpi').
+
+  Runs the selector given on the command line through the file
+  protocol once for every scenario below: the initial population
+  (state 1), 'GENERATIONS' selections (state 3) and the end of the
+  run (states 5 and 6). The objective values are drawn from a fixed
+  sequence, so all runs are the same. A scenario fails if the
+  selector ends with a non-zero exit code: a selector built with
+  'ALLOC_CHECK=1' does so if a generation allocated after the
+  warm-up.
+
+  With '-record directory' the scenarios for the default backend are
+  run instead, each writing a trace '<scenario>.trace' to the
+  directory, which femo_mpi_check.sh replays on several ranks.
+
+  Usage: femo_variator [-record directory] selector
+
+  C file.
+
+  file: femo_variator.c
+  last change: $date$
+
+  ========================================================================
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/*-------------------------| constants |--------------------------------*/
+
+#define GENERATIONS 60 /* selections of every scenario */
+
+#define STATE_TIMEOUT 30000 /* milliseconds to wait for the selector */
+
+#define FILE_NAME_LENGTH 256
+
+#define SHAPE_BOX 0 /* values drawn uniformly */
+#define SHAPE_FRONT 1 /* values near the line of a front (dim 2) */
+#define SHAPE_NAN 2 /* some values of the later individuals NaN */
+
+/*-------------------------| scenarios |--------------------------------*/
+
+typedef struct scenario_t
+{
+     char *name;
+     int dimension;
+     int alpha;
+     int mu;
+     int lambda;
+     int range; /* objective values are drawn from 0 to 'range' */
+     int shape; /* SHAPE_BOX, SHAPE_FRONT or SHAPE_NAN */
+     char *parameters; /* lines after 'seed' in the parameter file */
+} scenario;
+
+static scenario scenarios[] =
+{
+     {"unbounded", 3, 50, 10, 20, 100, SHAPE_BOX, ""},
+     {"max_archive", 3, 50, 10, 20, 100, SHAPE_BOX, "max_archive 40\n"},
+     {"bitset", 6, 50, 10, 20, 20, SHAPE_BOX, "archive_backend bitset\n"},
+     {"sorted2d", 2, 50, 10, 20, 1000, SHAPE_FRONT,
+      "archive_backend sorted2d\n"},
+     {"epsilon", 3, 50, 10, 20, 100, SHAPE_BOX, "epsilon 5 5 5\n"},
+     {"hypervolume", 4, 30, 10, 20, 6, SHAPE_BOX,
+      "hv_reference 10 10 10 10\nmax_archive 30\n"},
+     {"files", 3, 50, 10, 20, 100, SHAPE_BOX,
+      "history_file history.bin\nexport_file export.bin\n"
+      "stats_file stats.txt\ntombstone_limit 0\n"}
+};
+
+/* with '-record', only parameters the 'mpi' backend takes */
+static scenario record_scenarios[] =
+{
+     {"front", 2, 50, 10, 20, 1000, SHAPE_FRONT, ""},
+     {"box", 3, 50, 10, 20, 100, SHAPE_BOX, ""},
+     {"equal", 2, 50, 10, 20, 40, SHAPE_FRONT, ""},
+     {"many", 6, 100, 20, 50, 20, SHAPE_BOX, ""},
+     {"nan", 3, 50, 10, 20, 30, SHAPE_NAN, ""}
+};
+
+/*--------------------| global variable definitions |-------------------*/
+
+/* only used in this file */
+
+static char directory[] = "/tmp/femo_check_XXXXXX";
+
+static char file_name[FILE_NAME_LENGTH];
+
+static char selector[PATH_MAX]; /* the selector run, as absolute path */
+
+static char record_directory[PATH_MAX]; /* traces, "" if none */
+
+static unsigned long random_state = 1;
+
+static int next_identity = 0;
+
+static int selector_ended; /* 1 once the selector has been waited for */
+
+static int selector_status; /* its exit status */
+
+/*-------------------------| helper functions |-------------------------*/
+
+static char *path(char *name)
+/* Returns the name of the PISA file 'name' in the run directory. */
+{
+     sprintf(file_name, "%s/PISA_%s", directory, name);
+     return (file_name);
+}
+
+
+static int draw(int range)
+/* Returns the next value of the fixed sequence, from 0 to 'range'. */
+{
+     random_state = random_state * 1103515245UL + 12345UL;
+     return ((int) ((random_state >> 16) % 32768UL) % (range + 1));
+}
+
+
+static int write_text(char *name, char *text)
+/* Writes 'text' to the PISA file 'name'.
+   Returns 0 if successful and 1 otherwise. */
+{
+     FILE *fp;
+
+     fp = fopen(path(name), "w");
+     if (fp == NULL)
+          return (1);
+     fputs(text, fp);
+     fclose(fp);
+     return (0);
+}
+
+
+static int write_individuals(char *name, scenario *s, int count)
+/* Writes 'count' new individuals to the PISA file 'name'.
+   Returns 0 if successful and 1 otherwise. */
+{
+     FILE *fp;
+     int i, j, value, first;
+
+     fp = fopen(path(name), "w");
+     if (fp == NULL)
+          return (1);
+     fprintf(fp, "%d\n", count * (s->dimension + 1));
+     for (i = 0; i < count; i++)
+     {
+          fprintf(fp, "%d", next_identity++);
+          first = 0;
+          for (j = 0; j < s->dimension; j++)
+          {
+               value = draw(s->range);
+               if (j == 0)
+                    first = value;
+               if (s->shape == SHAPE_FRONT && j == 1)
+                    value = s->range - first + draw(s->range / 50);
+               if (s->shape == SHAPE_NAN && j == 1
+                   && next_identity >= 10 * s->alpha && value % 5 == 0)
+                    fprintf(fp, " nan");
+               else
+                    fprintf(fp, " %d", value);
+          }
+          fprintf(fp, "\n");
+     }
+     fprintf(fp, "END");
+     fclose(fp);
+     return (0);
+}
+
+
+static int read_state(void)
+/* Returns the state in the 'sta' file, -1 if it can't be read. */
+{
+     FILE *fp;
+     int state = -1;
+
+     fp = fopen(path("sta"), "r");
+     if (fp == NULL)
+          return (-1);
+     if (fscanf(fp, "%d", &state) != 1)
+          state = -1;
+     fclose(fp);
+     return (state);
+}
+
+
+static int wait_state(pid_t selector, int first, int second)
+/* Waits until the selector sets the state 'first' or 'second'.
+   Returns the state, -1 if the selector ended without it or took too
+   long. */
+{
+     int i, state;
+
+     for (i = 0; i < STATE_TIMEOUT; i++)
+     {
+          state = read_state();
+          if (state == first || state == second)
+               return (state);
+          if (waitpid(selector, &selector_status, WNOHANG) == selector)
+          {
+               /* it may have set the state just before it ended */
+               selector_ended = 1;
+               state = read_state();
+               return (state == first || state == second ? state : -1);
+          }
+          usleep(1000);
+     }
+     kill(selector, SIGKILL);
+     waitpid(selector, &selector_status, 0);
+     selector_ended = 1;
+     return (-1);
+}
+
+
+static int run_scenario(scenario *s)
+/* Runs the selector through scenario 's'.
+   Returns 0 if it ended without a report and 1 otherwise. */
+{
+     char parameter_file[FILE_NAME_LENGTH];
+     char base[FILE_NAME_LENGTH];
+     char text[128];
+     FILE *fp;
+     pid_t pid;
+     int generation, state;
+
+     random_state = 1;
+     next_identity = 0;
+     selector_ended = 0;
+     sprintf(parameter_file, "%s/param.txt", directory);
+     sprintf(base, "%s/PISA_", directory);
+
+     fp = fopen(parameter_file, "w");
+     if (fp == NULL)
+          return (1);
+     fprintf(fp, "seed 7\n%s", s->parameters);
+     if (record_directory[0] != '\0')
+          fprintf(fp, "record_file %s/%s.trace\n", record_directory, s->name);
+     fclose(fp);
+
+     sprintf(text, "alpha %d\nmu %d\nlambda %d\ndim %d\n",
+             s->alpha, s->mu, s->lambda, s->dimension);
+     if (write_text("cfg", text) != 0 || write_text("sel", "0") != 0
+         || write_text("arc", "0") != 0 || write_text("var", "0") != 0
+         || write_text("ini", "0") != 0 || write_text("sta", "0") != 0)
+          return (1);
+
+     pid = fork();
+     if (pid == -1)
+          return (1);
+     if (pid == 0)
+     {
+          if (chdir(directory) != 0)
+               _exit(1);
+          execl(selector, selector, parameter_file, base, "0.01",
+                (char *) NULL);
+          _exit(1);
+     }
+
+     if (write_individuals("ini", s, s->alpha) != 0
+         || write_text("sta", "1") != 0)
+          return (1);
+     for (generation = 0; ; generation++)
+     {
+          state = wait_state(pid, 2, 4);
+          if (state == -1)
+               return (1);
+          if (write_text("sel", "0") != 0 || write_text("arc", "0") != 0)
+               return (1);
+          if (state == 4 || generation == GENERATIONS)
+               break;
+          if (write_individuals("var", s, s->lambda) != 0
+              || write_text("sta", "3") != 0)
+               return (1);
+     }
+     if (write_text("sta", "5") != 0 || wait_state(pid, 7, 7) == -1)
+          return (1);
+     if (!selector_ended && waitpid(pid, &selector_status, 0) != pid)
+          return (1);
+     return (!WIFEXITED(selector_status)
+             || WEXITSTATUS(selector_status) != 0);
+}
+
+/*-------------------------| main() |-----------------------------------*/
+
+int main(int argc, char *argv[])
+{
+     scenario *run;
+     int i, count, failed;
+
+     run = scenarios;
+     count = (int) (sizeof(scenarios) / sizeof(scenario));
+     if (argc == 4 && strcmp(argv[1], "-record") == 0)
+     {
+          if (realpath(argv[2], record_directory) == NULL)
+          {
+               perror("femo_variator");
+               return (1);
+          }
+          run = record_scenarios;
+          count = (int) (sizeof(record_scenarios) / sizeof(scenario));
+          argv += 2;
+          argc -= 2;
+     }
+     if (argc != 2)
+     {
+          fprintf(stderr, "usage: femo_variator [-record directory] "
+                  "selector\n");
+          return (1);
+     }
+     if (realpath(argv[1], selector) == NULL || mkdtemp(directory) == NULL)
+     {
+          perror("femo_variator");
+          return (1);
+     }
+
+     failed = 0;
+     for (i = 0; i < count; i++)
+     {
+          if (run_scenario(&run[i]) != 0)
+          {
+               printf("%-12s FAILED\n", run[i].name);
+               failed++;
+          }
+          else
+               printf("%-12s ok\n", run[i].name);
+     }
+     printf("%d of %d scenarios failed, files in %s\n", failed, count,
+            directory);
+     return (failed > 0);
+}
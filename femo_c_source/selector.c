@@ -27,10 +27,21 @@
 #include <math.h>
 #include <time.h>
 #include <string.h>
+#include <limits.h>
 
 #include "selector.h"
 #include "selector_user.h"
 #include "selector_internal.h"
+#include "femo_trace.h"
+#include "femo_async.h"
+#include "femo_query.h"
+#include "femo_daemon.h"
+#include "femo_record.h"
+#include "femo_pipeline.h"
+#include "femo_history.h"
+#include "femo_poll.h"
+#include "femo_mpi.h"
+#include "femo_alloc.h"
 
 
 /*--------------------| global variable definitions |-------------------*/
@@ -45,6 +56,16 @@ int lambda; /* number of offspring individuals */
 
 int dimension; /* number of objectives */
 
+/* declared in selector.h */
+
+int channel_count = 1; /* number of channels: one per variator and
+                          those added by reserve_channel() */
+
+int variator_count = 1; /* number of variators, one per filenamebase */
+
+int current_channel = 0; /* variator whose files are being handled */
+
+
 /*-------------------------| main() |-----------------------------------*/
 
 int main(int argc, char *argv[])
@@ -52,18 +73,68 @@ int main(int argc, char *argv[])
      int returncode; /* storing the values that the state functions return */
      int current_state = 0;
 
+     double poll; /* polling interval in seconds */
 
-     char filenamebase[FILE_NAME_LENGTH_INTERNAL]; /* filename base,
-                                                      e.g. "dir/test." */
+     double span_begin; /* start of the current trace span */
 
-     double poll; /* polling interval in seconds */
+     int running; /* variators that haven't stopped yet */
+
+     int idle = 0; /* variators in a row that had nothing to do */
+
+     int previous_dimension;
+
+     int next; /* index of the next variator */
      
-     if (argc == 4)
+     /**** Changed for FEMO: with femo_mpi only rank 0 goes on, the
+           other ranks keep their part of the archive */
+     returncode = mpi_start(&argc, &argv);
+     if (returncode != -1)
+          return (returncode);
+
+     /* replay of a recorded run: 'femo -replay tracefile' */
+     if (argc == 3 && strcmp(argv[1], "-replay") == 0)
+     {
+          global_population.individual_array = NULL;
+          global_population.size = 0;
+          global_population.last_identity = -1;
+          return (replay_run(argv[2]));
+     }
+
+     /* archive history: 'femo -history file generation [last]' */
+     if ((argc == 4 || argc == 5) && strcmp(argv[1], "-history") == 0)
+     {
+          if (atoi(argv[3]) < 0
+              || (argc == 5 && atoi(argv[4]) < atoi(argv[3])))
+          {
+               printf("History: wrong generations\n");
+               return (1);
+          }
+          return (history_run(argv[2], atoi(argv[3]),
+                              atoi(argv[argc - 1])));
+     }
+
+     /* daemon mode: 'femo paramfile -daemon socket workers' */
+     if (argc == 5 && strcmp(argv[2], "-daemon") == 0)
+     {
+          if (mpi_ranks > 1)
+          {
+               printf("Selector - no daemon mode with several ranks\n");
+               return (1);
+          }
+          sscanf(argv[1], "%s", paramfile);
+          global_population.individual_array = NULL;
+          global_population.size = 0;
+          global_population.last_identity = -1;
+          return (daemon_run(argv[3], atoi(argv[4]) > 0 ? atoi(argv[4]) : 1));
+     }
+
+     /* one or more filename bases (e.g. "dir/test.") between the
+        parameter file and the polling interval */
+     if (argc >= 4)
      {
           sscanf(argv[1], "%s", paramfile); /* paramfile defined in
                                              * selector_user.h */
-          sscanf(argv[2], "%s", filenamebase);
-          sscanf(argv[3], "%lf", &poll);
+          sscanf(argv[argc - 1], "%lf", &poll);
           assert(poll >= 0);
      }
      else
@@ -72,37 +143,70 @@ int main(int argc, char *argv[])
           return (1);
      }  
      
-     /* generate file names based on 'filenamebase'*/
-     sprintf(var_file, "%svar", filenamebase);
-     sprintf(sel_file, "%ssel", filenamebase);
-     sprintf(cfg_file, "%scfg", filenamebase);
-     sprintf(ini_file, "%sini", filenamebase);
-     sprintf(arc_file, "%sarc", filenamebase);
-     sprintf(sta_file, "%ssta", filenamebase);
+     /* generate file names based on the filenamebases */
+     if (init_channels(argc - 3, argv + 2) != 0)
+          return (1);
+     running = variator_count;
 
      /* initialize global_population (just in case we terminate
         before the population is set up.) */
 
      global_population.individual_array = NULL;
+     global_population.size = 0;
+     global_population.last_identity = -1;
      
      
      /* state machine: uses the stateX() functions to do the steps required
         in state X. Those state functions have to be implemented by 
         the user in selector_user.c */
 
-     while (current_state != 6) /* stop state for selector */
+     while (running > 0)
           /* Caution: if reading of the statefile fails
              (e.g. no permission) this is an infinite loop */
+          /**** Changed for FEMO: unless 'state_timeout' is given */
      {
+          /* serve the variators in turn */
+          if (channel_count > 1)
+          {
+               next = current_channel;
+               do
+                    next = (next + 1) % channel_count;
+               while (channels[next].stopped);
+               if (next != current_channel)
+                    switch_channel(next);
+          }
+
           current_state = read_state();
+          /**** Changed for FEMO: turnaround and unreadable state */
+          if (poll_observe(current_state) != 0)
+               state_error(current_state, __LINE__);
           if (current_state == 1) /* inital selection */
           { 
+               idle = 0;
+               span_begin = trace_begin();
+               previous_dimension = dimension;
                read_common_parameters();
+               if (variator_count > 1 && previous_dimension != 0
+                   && dimension != previous_dimension)
+               {
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "variators differ in the number of objectives");
+                    state_error(1, __LINE__);
+               }
                
                returncode = state1();
                if (returncode == 0)
                {
-                    current_state = 2;
+                    if (is_finished()) /* ask variator to terminate */
+                    {
+                         /**** Changed for FEMO: the last 'arc' file
+                               has to be complete */
+                         if (pipeline_wait() != 0)
+                              state_error(1, __LINE__);
+                         current_state = 4;
+                    }
+                    else
+                         current_state = 2;
                     write_state(current_state);
                }
                else if (returncode != 2)
@@ -110,28 +214,87 @@ int main(int argc, char *argv[])
                     state_error(1, __LINE__);
                     
                }
+               trace_end("state1", "state", span_begin);
           }
           
           else if (current_state == 3) /* selection */
           {
-               if (check_sel() == 0 && check_arc() == 0)
+               idle = 0;
+               if (lambda == 0) /* restarted, state 1 was missed */
+               {
+                    read_common_parameters();
+                    returncode = restart();
+                    if (returncode == 1)
+                         state_error(3, __LINE__);
+                    else if (check_sel() != 0 || check_arc() != 0)
+                    {
+                         /* written by the selector before the restart */
+                         if (returncode == 0)
+                         {
+                              clear_file(var_file);
+                              current_state = 2;
+                              write_state(current_state);
+                              continue;
+                         }
+                         /* incomplete, select again */
+                         clear_file(sel_file);
+                         clear_file(arc_file);
+                    }
+               }
+
+               if (async_slots > 0) /* asynchronous mode, state 3 until
+                                       the optimization is finished */
                {
+                    returncode = state3();
+                    if (returncode == 0) /* ask variator to terminate */
+                    {
+                         current_state = 4;
+                         write_state(current_state);
+                    }
+                    else if (returncode != 2)
+                    {
+                         state_error(3, __LINE__);
+                    }
+                    else /* no worker finished yet, wait */
+                    {
+                         if (!query_enabled || answer_queries() == 2)
+                              wait(poll);
+                    }
+               }
+               else if (check_sel() == 0 && check_arc() == 0)
+               {
+                    span_begin = trace_begin();
                     returncode = state3();
                     if (returncode == 0)
                     {
-                         current_state = 2;
+                         /* the 'var' file is only released now, so an
+                            interrupted selection can be done again */
+                         clear_file(var_file);
+                         if (is_finished()) /* ask variator to terminate */
+                         {
+                              /**** Changed for FEMO: the last 'arc'
+                                    file has to be complete */
+                              if (pipeline_wait() != 0)
+                                   state_error(3, __LINE__);
+                              current_state = 4;
+                         }
+                         else
+                              current_state = 2;
                          write_state(current_state);
                     }
                     else if (returncode != 2)
                     {
                          state_error(3, __LINE__);
                     } /* else don't do anything and wait again */ 
+                    trace_end("state3", "state", span_begin);
                }
           }
           
           else if (current_state == 5) /* variator just terminated,
                                           here you can do what you want */
           {
+               idle = 0;
+               span_begin = trace_begin();
                returncode = state5();/* e.g., terminate too */
                if (returncode == 0)
                {
@@ -142,12 +305,15 @@ int main(int argc, char *argv[])
                {
                     state_error(5, __LINE__);
                } /* else don't do anything and wait again */ 
+               trace_end("state5", "state", span_begin);
 
           }
       
           else if (current_state == 9) /* variator ready for reset,
                                           here you can do what you want */
           {
+               idle = 0;
+               span_begin = trace_begin();
                returncode = state9();/* e.g., get ready for reset too */
                if (returncode == 0)
                {
@@ -158,14 +324,18 @@ int main(int argc, char *argv[])
                {
                     state_error(9, __LINE__);
                } /* else don't do anything and wait again */ 
+               trace_end("state9", "state", span_begin);
           }
       
           else if (current_state == 10) /* reset */
           {
+               idle = 0;
+               span_begin = trace_begin();
                returncode = state10();
                if (returncode == 0)
                {
-                    clean_population();
+                    if (variator_count == 1) /* otherwise see state10() */
+                         clean_population();
                     current_state = 11;
                     write_state(current_state);
                }
@@ -173,14 +343,40 @@ int main(int argc, char *argv[])
                {
                     state_error(10, __LINE__);
                } /* else don't do anything and wait again */ 
+               trace_end("state10", "state", span_begin);
           }
       
-          else /* state == -1 (reading failed) or state concerns variator */
+          else if (current_state != 6) /* state == -1 (reading failed)
+                                          or state concerns variator */
+          {
+               /* a query doesn't change the archive, so it can be
+                  answered while the variator has the turn */
+               if (current_state == 2 && query_enabled
+                   && answer_queries() != 2)
+                    idle = 0;
+               /* sleep once all variators had nothing to do */
+               else if (++idle >= running)
+               {
+                    /**** Changed for FEMO: adaptive interval */
+                    wait(poll_interval(poll));
+                    idle = 0;
+               }
+          }
+
+          if (current_state == 6) /* stop state for selector */
           {
-               wait(poll);
+               if (running == 1)
+                    break;
+               /* the others go on, the individuals of this variator
+                  stay in the archive */
+               channels[current_channel].stopped = 1;
+               running--;
+               current_state = 7;
+               write_state(current_state);
           }
-     } /* state == 6 (stop) */
+     } /* state == 6 (stop) for the last variator */
   
+     span_begin = trace_begin();
      returncode = state6();
      if (returncode == 0)
      {
@@ -190,8 +386,12 @@ int main(int argc, char *argv[])
      }
      else
           state_error(6, __LINE__);
-  
-     return (0);
+     trace_end("state6", "state", span_begin);
+
+     trace_close();
+     /**** Changed for FEMO: 'make check' fails on a reported
+           generation */
+     return (alloc_failures() > 0 ? 1 : 0);
 }
 
 /*-------------------------| populations functions |--------------------*/
@@ -207,6 +407,35 @@ individual *get_individual(int identity)
 }
 
 
+/* returns the channel an individual belongs to */
+int get_owner(int identity)
+{
+     return (identity % channel_count);
+}
+
+
+/* Maps the identity used by a channel to the identity in the global
+   population, -1 if it is out of range. With one channel both are
+   the same. */
+int get_identity(int channel, int identity)
+{
+     if (identity < 0 || identity > (INT_MAX - channel) / channel_count)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "identity out of range");
+          return (-1);
+     }
+     return (identity * channel_count + channel);
+}
+
+
+/* Maps an identity in the global population back to the one used by
+   its channel. */
+int get_local_identity(int identity)
+{
+     return (identity / channel_count);
+}
+
+
 /* returns the identity of the first individual in the global population */
 int get_first() 
 {
@@ -243,11 +472,14 @@ int get_size()
 
 
 /* Removes individual with ID 'identity' from the global population.
+   The individual is only marked as removed (its slot is NULL, so it is
+   skipped by get_next()), it is freed by compact_population().
    If successful returns 0, and 1 otherwise. */
 int remove_individual(int identity) 
 {
-     int last_id; 
+     int new_capacity;
      individual *temp;
+     individual **tmp;
      
      /* check for valid id */
      if(identity < 0 || identity > global_population.last_identity)
@@ -259,21 +491,76 @@ int remove_individual(int identity)
           return (1);
 
      global_population.individual_array[identity] = NULL;
-     /* free individual */
-     free_individual(temp);
-     /* if the id was the highest one we decrease the last id */
-     if(identity >= global_population.last_identity)
+     global_population.size--;
+
+     /* keep the individual as a tombstone */
+     if(global_population.tombstone_count
+        == global_population.tombstone_capacity)
      {
-          global_population.last_identity--;
-          last_id = global_population.last_identity;     
-          while(last_id > -1 &&
-                global_population.individual_array[last_id] == NULL)
+          new_capacity = global_population.tombstone_capacity == 0 ?
+               STANDARD_SIZE : global_population.tombstone_capacity * 2;
+          tmp = (individual **) realloc(global_population.tombstones,
+                                        new_capacity * sizeof(individual*));
+          if(tmp == NULL)
           {
-               global_population.last_identity--;
-               last_id = global_population.last_identity;
-          }	      
+               /* no room, free it right away */
+               free_individual(temp);
+               return (0);
+          }
+          global_population.tombstones = tmp;
+          global_population.tombstone_capacity = new_capacity;
      }
-     global_population.size--;
+     global_population.tombstones[global_population.tombstone_count++] =
+          temp;
+     return (0);
+}
+
+
+/* Frees all tombstones in one pass and decreases the last id to the
+   highest one still in use. */
+int compact_population()
+{
+     int i, last_id;
+
+     for(i = 0; i < global_population.tombstone_count; i++)
+          free_individual(global_population.tombstones[i]);
+     global_population.tombstone_count = 0;
+
+     if(global_population.individual_array == NULL)
+          return (0);
+     last_id = global_population.last_identity;
+     while(last_id > -1 &&
+           global_population.individual_array[last_id] == NULL)
+          last_id--;
+     global_population.last_identity = last_id;
+     return (0);
+}
+
+
+/* get number of removed individuals not freed yet */
+int get_tombstones()
+{
+     return (global_population.tombstone_count);
+}
+
+
+/* Makes room for 'count' tombstones, so that remove_individual()
+   allocates nothing. Returns 0 if successful and 1 otherwise. */
+int reserve_tombstones(int count)
+{
+     individual **tmp;
+
+     if (count <= global_population.tombstone_capacity)
+          return (0);
+     tmp = (individual **) realloc(global_population.tombstones,
+                                   count * sizeof(individual*));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     global_population.tombstones = tmp;
+     global_population.tombstone_capacity = count;
      return (0);
 }
 
@@ -296,14 +583,11 @@ int read_ini(int *id_array)
      int result; /* stores return value of called functions */
      int identity;
      double *objective_value;
+     double span_begin;
 
-     objective_value = (double *) malloc(dimension * sizeof(double));
-     if (objective_value == NULL)
-     {
-          log_to_file(log_file, __FILE__, __LINE__,
-                      "Selector out of memory.");
-          exit(EXIT_FAILURE);
-     }
+     span_begin = trace_begin();
+     objective_value = work_values; /**** Changed for FEMO: reused buffer,
+                                       see workspace_reserve() */
      
      
      fp = fopen(ini_file, "r");
@@ -317,7 +601,6 @@ int read_ini(int *id_array)
      {
           log_to_file(log_file, __FILE__, __LINE__, 
                       "size in ini file is wrong");
-          free(objective_value);
           fclose(fp);
           return (1);
      }
@@ -329,28 +612,31 @@ int read_ini(int *id_array)
                                                    if reading fails.*/
           if (result == EOF) /* file not completely written */
           {
-               free(objective_value);
                fclose(fp);
                return (1); /* signalling that reading failed */
           }
-          id_array[j] = identity;
           for (i = 0; i < dimension; i++)
           {
                /* reading fitness values of ind */
                result = fscanf(fp, "%le", &objective_value[i]);
                if (result == EOF) /* file not completely written */
                {
-                    free(objective_value);
                     fclose(fp);
                     return (1); /* signalling that reading failed */
                }
           }
           
           /* adding individual */
+          identity = get_identity(current_channel, identity);
+          id_array[j] = identity;
+          if (identity == -1)
+          {
+               fclose(fp);
+               return (1);
+          }
           result = add_individual(identity, objective_value);
           if (result != 0)
           {
-               free(objective_value);
                fclose(fp);
                return (1);
           }
@@ -360,7 +646,6 @@ int read_ini(int *id_array)
      fscanf(fp, "%s", tag);
      if (strcmp(tag, "END") != 0)
      {
-          free(objective_value);
           fclose(fp);
           return (1);  /* signalling that reading failed */
      }
@@ -374,7 +659,7 @@ int read_ini(int *id_array)
           fprintf(fp, "%d", 0);
           fclose(fp);
 
-          free(objective_value);
+          trace_end("read_ini", "io", span_begin);
           return (0);  
      }    
 }
@@ -395,14 +680,11 @@ int read_var(int *id_array)
      int result;
      int identity;
      double *objective_value;
+     double span_begin;
      
-     objective_value = (double *) malloc(dimension * sizeof(double));
-     if (objective_value == NULL)
-     {
-          log_to_file(log_file, __FILE__, __LINE__,
-                      "Selector out of memory.");
-          exit(EXIT_FAILURE);
-     }
+     span_begin = trace_begin();
+     objective_value = work_values; /**** Changed for FEMO: reused buffer,
+                                       see workspace_reserve() */
      fp = fopen(var_file, "r");
      assert(fp != NULL);
 
@@ -415,7 +697,6 @@ int read_var(int *id_array)
      {
           log_to_file(log_file, __FILE__, __LINE__,
                       "size in var file is wrong");
-          free(objective_value);
           fclose(fp);
           return (1);
      }
@@ -425,23 +706,27 @@ int read_var(int *id_array)
           /* reading index of individual */
           result = fscanf(fp, "%d", &identity); /* fscanf() returns EOF
                                                    if reading fails.*/     
-          id_array[j] = identity;
           for (i = 0; i < dimension; i++)
           {
                /* reading fitness values of ind */
                result = fscanf(fp, "%le", &objective_value[i]);
                if (result == EOF) /* file not completely written */
                {
-                    free(objective_value);
                     fclose(fp);
                     return (1); /* signalling that reading failed */
                }
           }
           /* adding individual */
+          identity = get_identity(current_channel, identity);
+          id_array[j] = identity;
+          if (identity == -1)
+          {
+               fclose(fp);
+               return (1);
+          }
           result = add_individual(identity, objective_value);
           if (result != 0)
           {
-               free(objective_value);
                fclose(fp);
                return (1);
           }
@@ -451,7 +736,6 @@ int read_var(int *id_array)
      fscanf(fp, "%s", tag);
      if (strcmp(tag, "END") != 0)
      {
-          free(objective_value);
           fclose(fp);
           return (1);  /* signalling that reading failed */
      }
@@ -459,13 +743,10 @@ int read_var(int *id_array)
      {
           fclose(fp);
 
-          /* deleting content */
-          fp = fopen(var_file, "w");
-          assert(fp != NULL);
-          fprintf(fp, "%d", 0);
-          fclose(fp);
+          /* the content is deleted by clear_file() once the selection
+             is complete */
 
-          free(objective_value);
+          trace_end("read_var", "io", span_begin);
           return (0);
      }   
 }
@@ -479,6 +760,7 @@ int write_sel(int *identity)
      FILE *fp;
      int i;
      int min_valid, max_valid;
+     double span_begin;
 
      if(identity == NULL)
           return (1);
@@ -488,7 +770,8 @@ int write_sel(int *identity)
      for(i = 0; i < mu; i++)
      {
           if (identity[i] < min_valid || identity[i] > max_valid 
-              || global_population.individual_array[identity[i]] == NULL) 
+              || global_population.individual_array[identity[i]] == NULL
+              || get_owner(identity[i]) != current_channel) 
           {
                log_to_file(log_file, __FILE__,
                            __LINE__, "bad id, checked in write_sel");
@@ -496,38 +779,62 @@ int write_sel(int *identity)
           } 
      }
 
+     span_begin = trace_begin();
      fp = fopen(sel_file, "w");
      assert(fp != NULL);
      fprintf(fp, "%d\n", mu);  
      for (i = 0; i < mu; i++)
      {
-          fprintf(fp, "%d", identity[i]);
+          fprintf(fp, "%d", get_local_identity(identity[i]));
           fprintf(fp,"\n");
      }
      fprintf(fp, "END");
      fclose(fp);
+     trace_end("write_sel", "io", span_begin);
      return (0);
 }
 
 
 int write_arc()  
 /* Writes all inidviduals in global population to arc file.
+   With several variators only those of the current one are written.
    Returns 0 if successful and 1 otherwise */
 {
      FILE *fp;
      int identity;
+     int size;
+     double span_begin;
+
+     span_begin = trace_begin();
+     size = global_population.size;
+     if (channel_count > 1)
+     {
+          size = 0;
+          identity = get_first();
+          while (identity != -1)
+          {
+               if (get_owner(identity) == current_channel)
+                    size++;
+               identity = get_next(identity);
+          }
+     }
+
      fp = fopen(arc_file, "w");
      assert(fp != NULL);
-     fprintf(fp, "%d\n", global_population.size);  
+     fprintf(fp, "%d\n", size);  
      identity = get_first();
      while (identity != -1)
      {
-          fprintf(fp, "%d", identity);
-          fprintf(fp, "\n");   
+          if (get_owner(identity) == current_channel)
+          {
+               fprintf(fp, "%d", get_local_identity(identity));
+               fprintf(fp, "\n");   
+          }
           identity = get_next(identity);
      }
      fprintf(fp, "END");
      fclose(fp);
+     trace_end("write_arc", "io", span_begin);
      return (0);
 }
 
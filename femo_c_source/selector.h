@@ -36,6 +36,17 @@ extern int lambda; /* number of offspring individuals */
 
 extern int dimension; /* number of objectives */
 
+/*-------------------------| variators |--------------------------------*/
+
+/* defined in selector.c */
+
+extern int channel_count; /* number of channels: one per variator and
+                             those added by reserve_channel() */
+
+extern int variator_count; /* number of variators, one per filenamebase */
+
+extern int current_channel; /* variator whose files are being handled */
+
 /*-------------------------| individual |-------------------------------*/
 
 typedef struct individual_t individual; 
@@ -64,6 +75,41 @@ int get_next(int identity);
 int get_size();
 /* Returns the size of the global population. */
 
+
+int compact_population();
+/* Frees the individuals removed since the last call and lowers the
+   largest identity in use accordingly. Returns 0. */
+
+
+int get_tombstones();
+/* Returns the number of removed individuals not freed yet. */
+
+
+int reserve_tombstones(int count);
+/* Makes room for 'count' removed individuals not freed yet.
+   Returns 0 if successful and 1 otherwise. */
+
+
+int get_owner(int identity);
+/* Returns the channel (0 .. channel_count - 1) of the individual
+   'identity', i.e. the variator whose files it was read from. */
+
+
+int get_identity(int channel, int identity);
+/* Returns the identity in the global population of the individual
+   'identity' of 'channel', -1 if it is out of range. */
+
+
+int get_local_identity(int identity);
+/* Returns the identity that the channel of the individual 'identity'
+   uses for it. */
+
+
+int reserve_channel();
+/* Adds a channel without files, for individuals that don't come from
+   a variator. It has to be called before any individual is added.
+   Returns the index of the channel, -1 if out of memory. */
+
 /*-------------------------| io |---------------------------------------*/
 
 int read_ini(int *id_array);
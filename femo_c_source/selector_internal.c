@@ -30,6 +30,8 @@
 #include "selector.h"
 #include "selector_user.h"
 #include "selector_internal.h"
+#include "femo_trace.h"
+#include "femo_alloc.h"
 
 /* this is needed for the wait function */
 #ifdef PISA_UNIX
@@ -65,25 +67,113 @@ char sta_file[FILE_NAME_LENGTH_INTERNAL];
 
 population global_population; /* pool of all existing individuals */
 
+channel *channels = NULL; /* one per variator */
+
 /* only used in this file */
 
 int current_max_size; 
 /* starting array size of the individuals array in global_population,
    defined in selector_internal.c */
 
+/*-------------------------| variators |--------------------------------*/
+
+int init_channels(int count, char **filenamebases)
+{
+     int i;
+     channel *c;
+
+     channels = (channel *) malloc(count * sizeof(channel));
+     if (channels == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     for (i = 0; i < count; i++)
+     {
+          c = &channels[i];
+          if (strlen(filenamebases[i]) + 4 > FILE_NAME_LENGTH_INTERNAL)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "filenamebase too long");
+               return (1);
+          }
+          sprintf(c->var_file, "%svar", filenamebases[i]);
+          sprintf(c->sel_file, "%ssel", filenamebases[i]);
+          sprintf(c->cfg_file, "%scfg", filenamebases[i]);
+          sprintf(c->ini_file, "%sini", filenamebases[i]);
+          sprintf(c->arc_file, "%sarc", filenamebases[i]);
+          sprintf(c->sta_file, "%ssta", filenamebases[i]);
+          c->alpha = 0;
+          c->mu = 0;
+          c->lambda = 0;
+          c->stopped = 0;
+     }
+     channel_count = count;
+     variator_count = count;
+     current_channel = 0;
+     switch_channel(0);
+     return (0);
+}
+
+
+int reserve_channel()
+{
+     channel *tmp;
+     channel *c;
+
+     tmp = (channel *) realloc(channels, (channel_count + 1) * sizeof(channel));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (-1);
+     }
+     channels = tmp;
+     c = &channels[channel_count];
+     memset(c, 0, sizeof(channel));
+     c->stopped = 1; /* no files, never served by main() */
+     return (channel_count++);
+}
+
+
+int switch_channel(int index)
+{
+     channel *c;
+
+     c = &channels[current_channel];
+     c->alpha = alpha;
+     c->mu = mu;
+     c->lambda = lambda;
+
+     c = &channels[index];
+     strcpy(cfg_file, c->cfg_file);
+     strcpy(ini_file, c->ini_file);
+     strcpy(sel_file, c->sel_file);
+     strcpy(arc_file, c->arc_file);
+     strcpy(var_file, c->var_file);
+     strcpy(sta_file, c->sta_file);
+     alpha = c->alpha;
+     mu = c->mu;
+     lambda = c->lambda;
+     current_channel = index;
+     return (0);
+}
+
 /*-------------------------| helper functions |-------------------------*/
 
 int write_state(int state)
 /* Write the state flag */
 {
      FILE *fp;
+     double span_begin;
 
      assert(0 <= state <= 11);
      
+     span_begin = trace_begin();
      fp = fopen(sta_file, "w");
      assert(fp != NULL);
      fprintf(fp, "%d", state);
      fclose(fp);
+     trace_end("write_state", "io", span_begin);
      return (0);
 }
 
@@ -121,6 +211,7 @@ int state_error(int error, int linenumber)
      printf("error in state %d \n", error);
      sprintf(error_message,"error in state %d \n", error);
      log_to_file(log_file, NULL, linenumber, error_message);
+     trace_close();
      exit(EXIT_FAILURE);
 }
 
@@ -128,10 +219,18 @@ int state_error(int error, int linenumber)
 int wait(double sec)
 /* Makes the calling process sleep for 'sec' seconds. */
 {
+     double span_begin;
 #ifdef PISA_UNIX
      unsigned int int_sec;
      unsigned int usec;
+#endif
+#ifdef PISA_WIN
+     unsigned int msec;
+#endif
+
+     span_begin = trace_begin();
 
+#ifdef PISA_UNIX
      assert(sec > 0);
      
      int_sec = (unsigned int) floor(sec);
@@ -150,13 +249,13 @@ int wait(double sec)
 #endif
 
 #ifdef PISA_WIN
-     unsigned int msec;
      assert(sec > 0);
      msec = (unsigned int) floor(sec * 1e3);
      assert(msec >= 10); /* making sure we are really sleeping for some time*/
      Sleep(msec);
 #endif
 
+     trace_end("wait", "poll", span_begin);
      return (0);
 }
 
@@ -167,7 +266,7 @@ int wait(double sec)
 int add_individual(int identity, double *objective_value)  
 /* function to add an individual to the global population*/
 {
-     int i, result;
+     int i, result, new_max_size;
      individual **tmp; /* in case we need to double array size */
      individual *to_add;
 
@@ -184,14 +283,19 @@ int add_individual(int identity, double *objective_value)
                            "selector out of memory");
                return (1);
           }       
+          for (i = 0; i < current_max_size; i++)
+               global_population.individual_array[i] = NULL;
           global_population.last_identity = -1;
      }
 
      if(identity >= current_max_size)
      {    
-          /* enlargement of individual array (size doubling) */
-          tmp = (individual **) malloc(sizeof(individual*) *
-                                        current_max_size * 2);
+          /* enlargement of individual array (size doubling), identities
+             need not arrive in ascending order (restored archive) */
+          new_max_size = current_max_size * 2;
+          while (identity >= new_max_size)
+               new_max_size = new_max_size * 2;
+          tmp = (individual **) malloc(sizeof(individual*) * new_max_size);
           if (tmp == NULL)
           {
                log_to_file(log_file, __FILE__, __LINE__,
@@ -201,10 +305,13 @@ int add_individual(int identity, double *objective_value)
           /* copy old array */
           for (i = 0; i < current_max_size; i++)
                tmp[i] = global_population.individual_array[i];
-          current_max_size = current_max_size * 2;
+          for (i = current_max_size; i < new_max_size; i++)
+               tmp[i] = NULL;
+          current_max_size = new_max_size;
           /* free memory */ 
           free(global_population.individual_array);
           global_population.individual_array = tmp;
+          alloc_grown(); /* FEMO: doubles with the identities */
      }
      /* create individual */
      to_add = create_individual();
@@ -248,13 +355,19 @@ int clean_population()
            remove_individual(current_id);
            current_id = get_next(current_id);
         }
+        compact_population();
 
         free(global_population.individual_array);
         
         global_population.individual_array = NULL;
         global_population.size = 0;
         global_population.last_identity = -1;
+
+        free(global_population.tombstones);
+        global_population.tombstones = NULL;
+        global_population.tombstone_capacity = 0;
      }
+     workspace_free(); /* FEMO: buffers and spare individuals */
      
      return (0);
 }
@@ -334,3 +447,18 @@ int check_arc()
      else
           return (1); /* file is not ready for writing */
 }
+
+
+int clear_file(char *filename)
+/* Writes '0' to 'filename' to signal that it has been read, or to
+   discard what the selector wrote before a restart. */
+{
+     FILE *fp;
+
+     fp = fopen(filename, "w");
+     if (fp == NULL)
+          return (1);
+     fprintf(fp, "%d", 0);
+     fclose(fp);
+     return (0);
+}
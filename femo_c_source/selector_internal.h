@@ -61,6 +61,34 @@ extern char sta_file[];
 /* 'sta' file (current state) */
 
 
+/*-------------------------| variators |--------------------------------*/
+
+/* files and common parameters of one variator */
+typedef struct channel_t
+{
+     char cfg_file[FILE_NAME_LENGTH_INTERNAL];
+     char ini_file[FILE_NAME_LENGTH_INTERNAL];
+     char sel_file[FILE_NAME_LENGTH_INTERNAL];
+     char arc_file[FILE_NAME_LENGTH_INTERNAL];
+     char var_file[FILE_NAME_LENGTH_INTERNAL];
+     char sta_file[FILE_NAME_LENGTH_INTERNAL];
+     int alpha;
+     int mu;
+     int lambda;
+     int stopped; /* 1 after the variator has reached state 7 */
+} channel;
+
+extern channel *channels; /* defined in selector_internal.c */
+
+int init_channels(int count, char **filenamebases);
+/* Sets up one channel per filenamebase and switches to the first one.
+   Returns 0 if successful and 1 otherwise. */
+
+int switch_channel(int index);
+/* Saves alpha, mu and lambda of the current channel and makes
+   'index' the current one: its file names are copied to the global
+   file names and its common parameters to the globals. */
+
 /*-------------------| functions for handling states |------------------*/
 
 int write_state(int state);
@@ -83,6 +111,10 @@ typedef struct population_t
      int size;        /* size of the population */
      individual **individual_array; /* array of individuals */
      int last_identity; /* largest identity- needed for memory management */
+     individual **tombstones; /* removed individuals, freed by
+                                 compact_population() */
+     int tombstone_count; /* number of entries in 'tombstones' */
+     int tombstone_capacity; /* allocated length of 'tombstones' */
 } population;
 
 /* the only population we need is */
@@ -109,4 +141,7 @@ int check_sel(void);
 int check_arc(void);
 /* Returns 0 if 'arc_file' contains only '0'and returns 1 otherwise. */
 
+int clear_file(char *filename);
+/* Writes '0' to the file. Returns 0 if successful and 1 otherwise. */
+
 #endif /* SELECTOR_INTERNAL.H */
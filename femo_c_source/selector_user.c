@@ -28,9 +28,30 @@
 #include <assert.h>
 #include <math.h>
 #include <string.h>
+#include <time.h>
 
 #include "selector.h"
 #include "selector_user.h"
+#include "femo_trace.h"
+#include "femo_hv.h"
+#include "femo_truncation.h"
+#include "femo_epsilon.h"
+#include "femo_duplicates.h"
+#include "femo_store.h"
+#include "femo_async.h"
+#include "femo_island.h"
+#include "femo_query.h"
+#include "femo_session.h"
+#include "femo_record.h"
+#include "femo_alloc.h"
+#include "femo_pipeline.h"
+#include "femo_export.h"
+#include "femo_history.h"
+#include "femo_backend.h"
+#include "femo_bulk.h"
+#include "femo_poll.h"
+#include "femo_search.h"
+#include "femo_mpi.h"
 
 /*--------------------| global variable definitions |-------------------*/
 
@@ -41,6 +62,130 @@ char *log_file = "femo_error.log"; /**** Changed for FEMO. */
 
 char paramfile[FILE_NAME_LENGTH]; /* file with local parameters */
 
+/**********| added for FEMO |**************/
+
+int generation = 0; /* number of selections since state 1 */
+
+int accepted = 0; /* new individuals accepted by the last selection */
+
+int orphaned = 0; /* 1 if the current variator has no individual left
+                     in the archive, so no parents could be selected */
+
+/* only used in this file */
+
+FILE *stats_fp = NULL; /* per generation statistics, NULL if disabled */
+
+int max_archive = 0; /* maximal archive size, 0 for unbounded */
+
+char archive_file[FILE_NAME_LENGTH] = ""; /* memory-mapped archive,
+                                             empty if not used */
+
+int parameters_read = 0; /* 1 after read_local_parameters() */
+
+int tombstone_limit = 1024; /* removed individuals that trigger a
+                               compaction, 0 for once per generation */
+
+int async_workers = 0; /* worker slots of the asynchronous mode, 0 for
+                          the synchronous state 2/3 cycle */
+
+int async_parents = 1; /* parents handed out per result */
+
+int async_finished = 0; /* 1 once a stopping criterion applied */
+
+int arc_outdated = 0; /* 1 if the archive changed since write_arc() */
+
+/* island model, only used if 'island_dir' is given */
+
+char island_dir[FILE_NAME_LENGTH] = ""; /* exchange directory */
+
+int island_id = 0; /* number of this island, from 0 */
+
+int island_count = 1; /* number of islands */
+
+int migration_interval = 10; /* generations between migrations */
+
+int migration_size = 10; /* maximal number of migrants exported */
+
+int migration_topology = ISLAND_RING;
+
+char record_path[FILE_NAME_LENGTH] = ""; /* trace of the offspring
+                                           stream, empty if not used */
+
+char history_path[FILE_NAME_LENGTH] = ""; /* log of the archive
+                                            changes, empty if not used */
+
+/* stopping criteria, 0 means not used */
+
+double max_time = 0; /* wall-clock budget in seconds */
+
+int max_generations = 0; /* maximal number of generations */
+
+int max_evaluations = 0; /* maximal number of evaluated individuals */
+
+int stagnation_generations = 0; /* stop after this many generations
+                                   without progress */
+
+double stagnation_hv_change = 0; /* relative hypervolume change up to
+                                    which a generation counts as
+                                    without progress */
+
+/* progress, updated after each selection by track_progress() */
+
+time_t start_time; /* time of the initial selection */
+
+int evaluations = 0; /* number of evaluated individuals */
+
+int stagnant_generations = 0; /* generations without progress in a row */
+
+double last_hv = 0; /* hypervolume after the previous selection */
+
+/* workspace of a run, see workspace_reserve() */
+
+double *work_values = NULL; /* objective values of the individual
+                               being read, 'dimension' */
+
+int *work_identities = NULL; /* new individuals of a generation */
+
+int *work_parents = NULL; /* parents of a generation */
+
+/* only used in this file */
+
+int work_values_size = 0;
+
+int work_identities_size = 0;
+
+int work_parents_size = 0;
+
+int *work_candidates = NULL; /* candidates of femo_choose() */
+
+int work_candidates_size = 0;
+
+int *work_members = NULL; /* members of the other variators, see
+                             spare_other_variators() */
+
+int work_members_size = 0;
+
+int *work_alive = NULL; /* members left per variator */
+
+int work_alive_size = 0;
+
+int *work_hits = NULL; /* members a new individual removes per variator */
+
+int work_hits_size = 0;
+
+individual **spare_individuals = NULL; /* freed individuals kept for
+                                          create_individual() */
+
+int spare_count = 0;
+
+int spare_capacity = 0;
+
+int work_capacity = 0; /* individuals the run is sized for */
+
+int handle_count = 0; /* handles given out, the size of the pool */
+
+/**********| addition for FEMO end |*******/
+
 
 /*-------------------------| individual |-------------------------------*/
 int set_objective_value(individual *ind, int index, double obj_value)
@@ -57,7 +202,7 @@ int set_objective_value(individual *ind, int index, double obj_value)
      else
      {
           /**********| added for FEMO |**************/
-          ind->objective_value[index] = obj_value;
+          ind->objective_value[index] = (objective_t) obj_value;
           /**********| addition for FEMO end |*******/
           
           return (0);
@@ -73,29 +218,50 @@ individual *create_individual()
 */
 {
      /**********| added for FEMO |**************/
-     double *obj_value;
+     objective_t *obj_value;
+     int slot = -1;
      /**********| addition for FEMO end |*******/
 
      individual *return_ind;
 
-     return_ind = (individual *) malloc(sizeof(individual));
-     if (return_ind == NULL)
+     /**** Changed for FEMO: freed individuals are reused */
+     if (spare_count > 0)
+          return_ind = spare_individuals[--spare_count];
+     else
      {
-          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
-          return(NULL);
+          return_ind = (individual *) malloc(sizeof(individual));
+          if (return_ind == NULL)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "selector out of memory");
+               return(NULL);
+          }
+          return_ind->objective_value = NULL;
+          return_ind->handle = handle_count++;
      }
 
      /**********| added for FEMO |**************/
 
-     obj_value = (double *) malloc(sizeof(double) * dimension);
+     /* a spare keeps its own objective values if it isn't file-backed */
+     if (store_enabled)
+     {
+          free(return_ind->objective_value);
+          obj_value = store_alloc(&slot);
+     }
+     else if (return_ind->objective_value != NULL)
+          obj_value = return_ind->objective_value;
+     else
+          obj_value = (objective_t *) malloc(sizeof(objective_t) * dimension);
      if (obj_value == NULL)
      {
           log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          free(return_ind);
           return(NULL);
      }
 
      return_ind->objective_value = obj_value;
      return_ind->counter = 0;
+     return_ind->slot = slot;
 
      /**********| addition for FEMO end |*******/
 
@@ -106,14 +272,37 @@ individual *create_individual()
 void free_individual(individual* ind)
 /* Frees the memory for one indiviual.
 
-   post: memory for ind is freed
+   post: memory for ind is freed (FEMO: kept for reuse, freed by
+         workspace_free())
 */
 {
      /**********| added for FEMO |**************/
-     free(ind->objective_value);
+     individual **tmp;
+     int new_capacity;
+
+     if (ind->slot != -1)
+     {
+          store_release(ind->slot);
+          ind->objective_value = NULL;
+     }
+
+     /* kept for the next create_individual(), see workspace_free() */
+     if (spare_count == spare_capacity)
+     {
+          new_capacity = spare_capacity == 0 ? 256 : 2 * spare_capacity;
+          tmp = (individual **) realloc(spare_individuals,
+                                        new_capacity * sizeof(individual *));
+          if (tmp == NULL)
+          {
+               free(ind->objective_value);
+               free(ind);
+               return;
+          }
+          spare_individuals = tmp;
+          spare_capacity = new_capacity;
+     }
+     spare_individuals[spare_count++] = ind;
      /**********| addition for FEMO end |*******/
-     
-     free(ind);
 }
 
 
@@ -149,65 +338,79 @@ int state1()
            values from the 'paramfile'. */
 
      /**********| added for FEMO |**************/
-     result = read_local_parameters();  
-     if (result != 0)
-     { 
-          log_to_file(log_file, __FILE__, __LINE__,
-                      "couldn't read local parameters");
-          return (1);
+     /* with several variators the first one sets up the archive, the
+        others join it */
+     if (variator_count == 1 || !parameters_read)
+     {
+          result = read_local_parameters();  
+          if (result != 0)
+          { 
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "couldn't read local parameters");
+               return (1);
+          }
+          if (archive_file[0] != '\0' && store_open(archive_file, 0) != 0)
+               return (1);
+          if (async_workers > 0)
+          {
+               if (archive_file[0] != '\0')
+               {
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "archive_file can't be used with async_workers");
+                    return (1);
+               }
+               if (async_init(async_workers, 1) != 0)
+                    return (1);
+               async_finished = 0;
+               arc_outdated = 0;
+          }
+
+          start_run();
      }
      /**********| addition for FEMO end |*******/
 
      
-     result_identities = (int *) malloc(alpha * sizeof (int));
-     if (result_identities == NULL)
-     {
-          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+     /**** Changed for FEMO: the buffers are kept for the whole run */
+     if (workspace_reserve() != 0)
           return (1);
-     }
+     result_identities = work_identities;
+     PISA_identities = work_parents;
      
      result = read_ini(result_identities);   /* read ini file */
      if (result == 1)
           return (2); /* reading ini file failed */
-    
-
-     PISA_identities = (int *) malloc(mu * sizeof (int));
-     if (result_identities == NULL)
-     {
-          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
-          return (1);
-     }
      
      /**********| added for FEMO |**************/
 
-     result = select_ind(alpha, result_identities,
-                         PISA_identities, dimension); /* changedddd */
+     result = run_selection(alpha, result_identities,
+                            PISA_identities); /* changedddd */
 
      if (result != 0)
-     {
-          log_to_file(log_file, __FILE__, __LINE__, "selection failed");
           return (1);
-     }
      
      /**********| addition for FEMO end |*******/
 
-     result = write_sel(PISA_identities);     /* write sel file */
+     if (!orphaned) /**** Changed for FEMO, see is_finished(). */
+          result = write_sel(PISA_identities);     /* write sel file */
      if(result != 0)
      {
           log_to_file(log_file, __FILE__, __LINE__, "failed write_sel()");
           return(1);
      }
-     
-     free(PISA_identities);
-     free(result_identities);
 
-     result = write_arc();     /* write arc file
+     /**** Changed for FEMO: possibly written in the background */
+     result = pipeline_enabled ? pipeline_arc() : write_arc();
+                               /* write arc file
                                   (individuals in global population) */
      if(result != 0)
      {
           log_to_file(log_file, __FILE__, __LINE__, "failed write_arc()");
           return(1);
      }
+
+     /**********| added for FEMO |**************/
+     store_complete();
+     /**********| addition for FEMO end |*******/
   
      return (0);   
 }  
@@ -229,25 +432,27 @@ int state3()
          return value == 0 if successful,
                       == 1 if unspecified errors happened,
                       == 2 if file reading failed.
+
+   remark: In the asynchronous mode the results of the workers are
+           processed instead, see select_async().
 */
 {
      int result; /* stores return values of called functions */
      int *offspring_identities; /* array with IDs filled by read_var() */
      int *parent_identities; /* array with IDs of parents */
 
-     offspring_identities = (int *) malloc(lambda * sizeof(int)); 
-     if (offspring_identities == NULL)
-     {
-          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
-          return (1);
-     }
+     /**********| added for FEMO |**************/
+     if (async_slots > 0)
+          return (select_async());
+     /**********| addition for FEMO end |*******/
 
-     parent_identities = (int *) malloc(mu * sizeof(int)); 
-     if (parent_identities == NULL)
-     {
-          log_to_file(log_file, __FILE__, __LINE__, "variator out of memory");
+     /**** Changed for FEMO: the buffers are kept for the whole run,
+           this allocates only if mu or lambda grew */
+     alloc_begin();
+     if (workspace_reserve() != 0)
           return (1);
-     }
+     offspring_identities = work_identities;
+     parent_identities = work_parents;
      
      result = read_var(offspring_identities);
      if (result == 1) /* if some file reading error occurs, return 2 */
@@ -255,28 +460,25 @@ int state3()
 
      /**********| added for FEMO |**************/
 
-     result = select_ind(lambda, offspring_identities,
-                         parent_identities, dimension);
+     generation++;
+     result = run_selection(lambda, offspring_identities,
+                            parent_identities);
      
      if (result != 0)
-     {
-          log_to_file(log_file, __FILE__, __LINE__, "selection failed");
           return (1);
-     }
          
      /**********| addition for FEMO end |*******/
 
-     result = write_sel(parent_identities);
+     if (!orphaned) /**** Changed for FEMO, see is_finished(). */
+          result = write_sel(parent_identities);
      if(result != 0)
      {
           log_to_file(log_file, __FILE__, __LINE__, "failed write_sel()");
           return(1);
      }
 
-     free(parent_identities);
-     free(offspring_identities);
-
-     result = write_arc();
+     /**** Changed for FEMO: possibly written in the background */
+     result = pipeline_enabled ? pipeline_arc() : write_arc();
      
      if(result != 0)
      {
@@ -284,10 +486,64 @@ int state3()
           return (1);
      }
 
+     /**********| added for FEMO |**************/
+     store_complete();
+     alloc_end(generation);
+     /**********| addition for FEMO end |*******/
+
      return (0);   
 }  
 
 
+int restart()
+/* Do what needs to be done if the selector is started in state 3.
+
+   pre: The common parameters have been read. The selector has been
+        restarted (e.g. after a crash) while the variator waits for a
+        selection.
+
+   post: local parameters read
+         archive restored from the archive file (if there is one)
+         return value == 0 if the last selection had been completed,
+                      == 1 if unspecified errors happened,
+                      == 2 if the last selection may have been
+                           interrupted and has to be done again.
+*/
+{
+     int result;
+
+     /**********| added for FEMO |**************/
+     if (variator_count > 1 && parameters_read)
+          return (2); /* joins the archive of the other variators */
+     result = read_local_parameters();
+     if (result != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't read local parameters");
+          return (1);
+     }
+     if (async_workers > 0)
+     {
+          if (async_init(async_workers, 0) != 0)
+               return (1);
+          async_finished = 0;
+          arc_outdated = 1;
+     }
+     if (archive_file[0] == '\0')
+          return (2);
+
+     result = femo_restore();
+     if (result != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "couldn't restore archive");
+          return (1);
+     }
+     return (store_selecting() ? 2 : 0);
+     /**********| addition for FEMO end |*******/
+}
+
+
 int state5()
 /* Do what needs to be done in state 5.
 
@@ -316,6 +572,15 @@ int state6()
 */
 {
      int current_id;
+
+     /**********| added for FEMO |**************/
+     export_archive(1); /* the final archive */
+     export_free();
+     history_close();
+     pipeline_free(); /* the last 'arc' file is written */
+     store_close(); /* keeps the last completed generation */
+     poll_free();
+     /**********| addition for FEMO end |*******/
     
      current_id = get_first();
      while(current_id != -1) /* freeing memory */
@@ -323,6 +588,25 @@ int state6()
           remove_individual(current_id);
           current_id = get_next(current_id);
      }
+
+     /**********| added for FEMO |**************/
+     hv_free();
+     truncation_free();
+     backend_free();
+     search_free();
+     query_free();
+     epsilon_free();
+     duplicate_free();
+     async_free();
+     island_free();
+     record_close();
+     if (stats_fp != NULL)
+     {
+          fclose(stats_fp);
+          stats_fp = NULL;
+     }
+     /**********| addition for FEMO end |*******/
+
      return (0);
 }
 
@@ -356,6 +640,41 @@ int state10()
 */
 {
    /* freeing memory is done in selector.c */
+
+   /**********| added for FEMO |**************/
+   int current_id, next_id;
+
+   /* with several variators only the individuals of this one leave
+      the archive, it rejoins in state 1 */
+   if (variator_count > 1)
+   {
+        current_id = get_first();
+        while (current_id != -1)
+        {
+             next_id = get_next(current_id);
+             if (get_owner(current_id) == current_channel
+                 && femo_remove(current_id) != 0)
+                  return (1);
+             current_id = next_id;
+        }
+        return (0);
+   }
+
+   export_archive(1);
+   export_free();
+   history_close();
+   hv_clear();
+   truncation_clear();
+   backend->clear();
+   search_clear();
+   epsilon_clear();
+   duplicate_clear();
+   store_close();
+   async_free();
+   record_close();
+   pipeline_free();
+   /**********| addition for FEMO end |*******/
+
    return (0);
 }
 
@@ -367,10 +686,42 @@ int is_finished()
    post: return value == 1 if optimization should stop
          return value == 0 if optimization should continue
 
-   remark: Normally the variator decides when to terminate. So
-           just return 0.
+   remark: Normally the variator decides when to terminate. FEMO
+           stops if one of the criteria from the parameter file
+           applies. All counters are kept up to date by
+           track_progress(), so this is cheap.
 */
 {
+     /**********| added for FEMO |**************/
+     if (orphaned)
+     {
+          printf("Selector: no individuals of variator %d left.\n",
+                 current_channel);
+          return (1);
+     }
+     if (max_time > 0 && difftime(time(NULL), start_time) >= max_time)
+     {
+          printf("Selector: time budget exhausted.\n");
+          return (1);
+     }
+     if (max_generations > 0 && generation >= max_generations)
+     {
+          printf("Selector: maximal number of generations reached.\n");
+          return (1);
+     }
+     if (max_evaluations > 0 && evaluations >= max_evaluations)
+     {
+          printf("Selector: maximal number of evaluations reached.\n");
+          return (1);
+     }
+     if (stagnation_generations > 0
+         && stagnant_generations >= stagnation_generations)
+     {
+          printf("Selector: archive stagnated.\n");
+          return (1);
+     }
+     /**********| addition for FEMO end |*******/
+
      return (0);
 }
 
@@ -380,16 +731,26 @@ int is_finished()
 
 int read_local_parameters()
 {
-     
      FILE *fp;
 
-     int result;
-     char str[CFG_NAME_LENGTH];
-     int seed;
-
      /* reading parameter file with parameters for selection */
      fp = fopen(paramfile, "r"); 
      assert(fp != NULL);
+     return (read_parameters(fp));
+}
+
+
+/* Reads the local parameters from 'fp', which is closed. */
+int read_parameters(FILE *fp)
+{
+     int result;
+     size_t length;
+     char str[CFG_NAME_LENGTH];
+     char value[FILE_NAME_LENGTH];
+     int seed;
+     int i;
+     double *reference;
+     double *epsilon;
 
      fscanf(fp, "%s", str);
      assert(strcmp(str, "seed") == 0);
@@ -399,147 +760,956 @@ int read_local_parameters()
      
      srand(seed); /* seeding random number generator */
 
-     fclose(fp);
-  
-     /* do some other initialization steps... */
-     return (0);
-}
-
-
-/* Implements FEMO. Takes size individual from variation, updates global
-   population and selects mu new individual for variation. */
-int select_ind(int size, int *new_identity, int *sel_identities,
-               int dimension)
-{
-     int i, pos;
-     int dominated = 0;
-     int equal = 0;
-     int current_identity;
-     int result;
-
-     assert(dimension >= 0);
-
-     /* delete all by new_identity dominated individuals */
-     for(i = 0; i < size; i++)
+     /* optional parameters, given as 'name value' pairs */
+     while (fscanf(fp, "%s", str) == 1)
      {
-          /* only if new_identity[i] not removed yet */
-          if(get_individual(new_identity[i]) != NULL)
+          if (strcmp(str, "trace_file") == 0)
           {
-               /* deleting all individuals which are
-                  dominated by new_identity[i]*/
-               current_identity = get_first();
-               while(current_identity != -1)
+               result = fscanf(fp, "%s", value);
+               assert(result != EOF);
+               if (replay_running)
                {
-                    /* skip, if trying to compare to self */
-                    if(current_identity == new_identity[i])
-                         current_identity = get_next(current_identity);
-                    if(current_identity == -1)
-                         break;
-                    /* domination testing */
-                    if(dominates(new_identity[i], current_identity,
-                                 dimension))
+                    /* the trace of the recorded run is kept, the replay
+                       writes '<name>.replay.json' ('.json' replaced) */
+                    length = strlen(value);
+                    if (length >= 5 && strcmp(value + length - 5, ".json") == 0)
+                         value[length - 5] = '\0';
+                    if (strlen(value) + 12 >= FILE_NAME_LENGTH)
                     {
-                         result = remove_individual(current_identity);
-                         if(result != 0)
-                         {
-                              log_to_file(log_file, __FILE__, __LINE__, 
-                                          "removing individual failed");
-                              return (1);
-                         }
-                    } 
-                    current_identity = get_next(current_identity);
+                         log_to_file(log_file, __FILE__, __LINE__,
+                                     "name of the trace file too long");
+                         fclose(fp);
+                         return (1);
+                    }
+                    strcat(value, ".replay.json");
+               }
+               if (trace_open(value) != 0)
+               {
+                    fclose(fp);
+                    return (1);
                }
           }
-     }
-
-     /* check if new are dominated or equal in all objective values */ 
-     for(i = size-1; i >= 0 ; i--)
-     {
-          equal = 0;
-          dominated = 0;
-
-          /* only if new_identity[i] not removed yet */
-          if (get_individual(new_identity[i]) != NULL)
+          else if (strcmp(str, "stats_file") == 0)
           {
-               current_identity = get_first();
-               while (current_identity != -1 && !dominated && !equal)
+               result = fscanf(fp, "%s", value);
+               assert(result != EOF);
+               if (replay_running)
+                    continue; /* belongs to the recorded run */
+               if (stats_fp != NULL)
+                    fclose(stats_fp);
+               stats_fp = fopen(value, "w");
+               if (stats_fp == NULL)
                {
-                    /* skip, if trying to compare to self */
-                    if(current_identity == new_identity[i])
-                         current_identity = get_next(current_identity);
-                    if(current_identity == -1)
-                         break;	   
-	   
-                    if (dominates(current_identity, new_identity[i],
-                                  dimension))
-                         dominated = 1;
-                    if (is_equal(current_identity, new_identity[i],
-                                 dimension))
-                         equal = 1;
-	   
-                    current_identity = get_next(current_identity);
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "couldn't open stats file");
+                    fclose(fp);
+                    return (1);
                }
-
-               if (dominated || equal) /* remove new from global population */
+               fprintf(stats_fp, "# generation size hypervolume\n");
+          }
+          else if (strcmp(str, "max_archive") == 0)
+          {
+               result = fscanf(fp, "%d", &max_archive);
+               assert(result == 1 && max_archive >= 0);
+               if (max_archive > 0 && truncation_init() != 0)
                {
-                    result=remove_individual(new_identity[i]);
-                    if (result != 0)
-                    {
-                
-                         log_to_file(log_file, __FILE__, __LINE__,
-                                     "removing individual failed");
-                         return (1);
-                    }
-           
+                    fclose(fp);
+                    return (1);
                }
           }
-     }
-       
-     /* uniformly choose mu individual as described in femo */
-     for(i = 0; i < mu; i++)
-     {
-          pos = femo_choose();
-          if (pos == -1) /* Choosing failed. */
-               return (1);
-          increase_counter(pos);
-          sel_identities[i] = pos;
-     }
-     return (0);
-}
-
-
-/* Determines if one individual dominates another.
-   Minimizing fitness values. */
-int dominates(int ind_a, int ind_b, int dim)
-{
-     int i;
-     int a_is_worse = 0;
-     int equal = 1;
-     double obj_a, obj_b;
-     for (i = 0; i < dim && !a_is_worse; i++)
-     {
-          obj_a = get_objective_value(ind_a,i);
-          obj_b = get_objective_value(ind_b,i);
-          a_is_worse = obj_a > obj_b;
-          equal = (obj_a == obj_b) && equal;
-     }
-     
-     return (!equal && !a_is_worse);
-}
-
-
-/* Determines if two individuals are equal in all objective values.*/
-int is_equal(int ind_a, int ind_b, int dim)
-{
-     int i;
-     int equal = 1;
-     
-     for (i = 0; i < dim; i++)
-          equal = (get_objective_value(ind_a,i) 
-		   == get_objective_value(ind_b,i)) && equal;
-     return (equal);
-}
-
+          else if (strcmp(str, "archive_backend") == 0)
+          {
+               result = fscanf(fp, "%31s", backend_name);
+               assert(result != EOF);
+          }
+          else if (strcmp(str, "expected_archive") == 0)
+          {
+               result = fscanf(fp, "%d", &expected_archive);
+               assert(result == 1 && expected_archive >= 0);
+          }
+          else if (strcmp(str, "bulk_threads") == 0)
+          {
+               result = fscanf(fp, "%d", &bulk_threads);
+               assert(result == 1 && bulk_threads >= 0);
+          }
+          else if (strcmp(str, "poll_adaptive") == 0)
+          {
+               result = fscanf(fp, "%d", &poll_adaptive);
+               assert(result == 1
+                      && (poll_adaptive == 0 || poll_adaptive == 1));
+          }
+          else if (strcmp(str, "poll_max") == 0)
+          {
+               result = fscanf(fp, "%le", &poll_max);
+               assert(result == 1 && poll_max > 0);
+          }
+          else if (strcmp(str, "state_timeout") == 0)
+          {
+               result = fscanf(fp, "%le", &state_timeout);
+               assert(result == 1 && state_timeout >= 0);
+          }
+          else if (strcmp(str, "state_timeout_abort") == 0)
+          {
+               result = fscanf(fp, "%d", &state_timeout_abort);
+               assert(result == 1 && (state_timeout_abort == 0
+                                      || state_timeout_abort == 1));
+          }
+          else if (strcmp(str, "archive_file") == 0)
+          {
+               result = fscanf(fp, "%s", archive_file);
+               assert(result != EOF);
+          }
+          else if (strcmp(str, "async_workers") == 0)
+          {
+               result = fscanf(fp, "%d", &async_workers);
+               assert(result == 1 && async_workers >= 0);
+          }
+          else if (strcmp(str, "async_parents") == 0)
+          {
+               result = fscanf(fp, "%d", &async_parents);
+               assert(result == 1 && async_parents >= 1);
+          }
+          else if (strcmp(str, "island_dir") == 0)
+          {
+               result = fscanf(fp, "%s", island_dir);
+               assert(result != EOF);
+          }
+          else if (strcmp(str, "island_id") == 0)
+          {
+               result = fscanf(fp, "%d", &island_id);
+               assert(result == 1 && island_id >= 0);
+          }
+          else if (strcmp(str, "island_count") == 0)
+          {
+               result = fscanf(fp, "%d", &island_count);
+               assert(result == 1 && island_count >= 1);
+          }
+          else if (strcmp(str, "migration_interval") == 0)
+          {
+               result = fscanf(fp, "%d", &migration_interval);
+               assert(result == 1 && migration_interval >= 1);
+          }
+          else if (strcmp(str, "migration_size") == 0)
+          {
+               result = fscanf(fp, "%d", &migration_size);
+               assert(result == 1 && migration_size >= 0);
+          }
+          else if (strcmp(str, "migration_topology") == 0)
+          {
+               result = fscanf(fp, "%s", value);
+               assert(result != EOF);
+               if (strcmp(value, "ring") == 0)
+                    migration_topology = ISLAND_RING;
+               else if (strcmp(value, "all") == 0)
+                    migration_topology = ISLAND_ALL;
+               else
+               {
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "unknown migration_topology");
+                    fclose(fp);
+                    return (1);
+               }
+          }
+          else if (strcmp(str, "query_files") == 0)
+          {
+               result = fscanf(fp, "%d", &query_enabled);
+               assert(result == 1 && (query_enabled == 0 || query_enabled == 1));
+          }
+          else if (strcmp(str, "record_file") == 0)
+          {
+               result = fscanf(fp, "%s", value);
+               assert(result != EOF);
+               if (!replay_running)
+                    strcpy(record_path, value);
+          }
+          else if (strcmp(str, "export_file") == 0)
+          {
+               result = fscanf(fp, "%s", value);
+               assert(result != EOF);
+               if (!replay_running) /* belongs to the recorded run */
+                    strcpy(export_file, value);
+          }
+          else if (strcmp(str, "export_interval") == 0)
+          {
+               result = fscanf(fp, "%d", &export_interval);
+               assert(result == 1 && export_interval >= 0);
+          }
+          else if (strcmp(str, "pipelined_arc") == 0)
+          {
+               result = fscanf(fp, "%d", &pipeline_enabled);
+               assert(result == 1
+                      && (pipeline_enabled == 0 || pipeline_enabled == 1));
+          }
+          else if (strcmp(str, "history_file") == 0)
+          {
+               result = fscanf(fp, "%s", value);
+               assert(result != EOF);
+               if (!replay_running)
+                    strcpy(history_path, value);
+          }
+          else if (strcmp(str, "history_keyframe") == 0)
+          {
+               result = fscanf(fp, "%d", &history_keyframe);
+               assert(result == 1 && history_keyframe >= 1);
+          }
+          else if (strcmp(str, "tombstone_limit") == 0)
+          {
+               result = fscanf(fp, "%d", &tombstone_limit);
+               assert(result == 1 && tombstone_limit >= 0);
+          }
+          else if (strcmp(str, "max_time") == 0)
+          {
+               result = fscanf(fp, "%le", &max_time);
+               assert(result == 1 && max_time >= 0);
+          }
+          else if (strcmp(str, "max_generations") == 0)
+          {
+               result = fscanf(fp, "%d", &max_generations);
+               assert(result == 1 && max_generations >= 0);
+          }
+          else if (strcmp(str, "max_evaluations") == 0)
+          {
+               result = fscanf(fp, "%d", &max_evaluations);
+               assert(result == 1 && max_evaluations >= 0);
+          }
+          else if (strcmp(str, "stagnation_generations") == 0)
+          {
+               result = fscanf(fp, "%d", &stagnation_generations);
+               assert(result == 1 && stagnation_generations >= 0);
+          }
+          else if (strcmp(str, "stagnation_hv_change") == 0)
+          {
+               result = fscanf(fp, "%le", &stagnation_hv_change);
+               assert(result == 1 && stagnation_hv_change >= 0);
+          }
+          else if (strcmp(str, "hv_reference") == 0)
+          {
+               reference = (double *) malloc(dimension * sizeof(double));
+               if (reference == NULL)
+               {
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "selector out of memory");
+                    fclose(fp);
+                    return (1);
+               }
+               for (i = 0; i < dimension; i++)
+               {
+                    result = fscanf(fp, "%le", &reference[i]);
+                    assert(result == 1);
+               }
+               result = hv_init(reference);
+               free(reference);
+               if (result != 0)
+               {
+                    fclose(fp);
+                    return (1);
+               }
+          }
+          else if (strcmp(str, "epsilon") == 0)
+          {
+               epsilon = (double *) malloc(dimension * sizeof(double));
+               if (epsilon == NULL)
+               {
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "selector out of memory");
+                    fclose(fp);
+                    return (1);
+               }
+               for (i = 0; i < dimension; i++)
+               {
+                    result = fscanf(fp, "%le", &epsilon[i]);
+                    assert(result == 1 && epsilon[i] > 0);
+               }
+               result = epsilon_init(epsilon);
+               free(epsilon);
+               if (result != 0)
+               {
+                    fclose(fp);
+                    return (1);
+               }
+          }
+          else
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "unknown local parameter");
+               fclose(fp);
+               return (1);
+          }
+     }
+
+     fclose(fp);
+     if (variator_count > 1 && (archive_file[0] != '\0' || async_workers > 0))
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "archive_file and async_workers need one variator");
+          return (1);
+     }
+     if (daemon_enabled && (archive_file[0] != '\0' || async_workers > 0
+                            || island_dir[0] != '\0' || export_file[0] != '\0'))
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "archive_file, async_workers, island_dir and export_file can't be used in sessions");
+          return (1);
+     }
+     if (pipeline_enabled && (archive_file[0] != '\0' || async_workers > 0
+                              || variator_count > 1 || daemon_enabled))
+     {
+          /* a restored archive needs all files of its last generation,
+             the others write 'arc' files of their own */
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "pipelined_arc can't be used with archive_file, async_workers, several variators or sessions");
+          return (1);
+     }
+     if (record_path[0] != '\0')
+     {
+          /* the replay knows neither restored archives, workers,
+             migrants nor other variators */
+          if (archive_file[0] != '\0' || async_workers > 0
+              || island_dir[0] != '\0' || variator_count > 1
+              || daemon_enabled)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "record_file can't be used with archive_file, async_workers, island_dir, several variators or sessions");
+               return (1);
+          }
+          if (record_open(record_path) != 0)
+               return (1);
+     }
+     if (island_dir[0] != '\0')
+     {
+          assert(island_id < island_count);
+          if (island_init(island_dir, island_id, island_count,
+                          migration_interval, migration_size,
+                          migration_topology) != 0)
+               return (1);
+     }
+     if (history_path[0] != '\0')
+     {
+          /* a restored archive would continue an unfinished log, the
+             sessions would share it */
+          if (archive_file[0] != '\0' || daemon_enabled)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "history_file can't be used with archive_file or sessions");
+               return (1);
+          }
+          if (history_open(history_path) != 0) /* after island_init(),
+                                                   which adds a channel */
+               return (1);
+     }
+     if (backend_select(max_archive > 0 ? max_archive : expected_archive) != 0)
+          return (1);
+     /* rank 0 of femo_mpi frees the objective values of the members */
+     if (mpi_active && (hv_enabled || max_archive > 0
+                        || archive_file[0] != '\0' || island_dir[0] != '\0'
+                        || export_file[0] != '\0' || history_path[0] != '\0'
+                        || variator_count > 1))
+     {
+          log_to_file(log_file, __FILE__, __LINE__,
+                      "archive_backend mpi can't be used with hv_reference, max_archive, archive_file, island_dir, export_file, history_file or several variators");
+          return (1);
+     }
+     parameters_read = 1;
+  
+     /* do some other initialization steps... */
+     return (0);
+}
+
+
+/* Makes '*buffer' (of '*size' ints) hold at least 'count' ints, at
+   least doubling it if it has to grow. Returns 0 if successful and 1
+   if out of memory. */
+int grow_ints(int **buffer, int *size, int count)
+{
+     int *tmp;
+     int new_size;
+
+     if (count <= *size)
+          return (0);
+     new_size = 2 * *size > count ? 2 * *size : count;
+     tmp = (int *) realloc(*buffer, new_size * sizeof(int));
+     if (tmp == NULL)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+          return (1);
+     }
+     *buffer = tmp;
+     *size = new_size;
+     return (0);
+}
+
+
+/* Makes the workspace large enough for the current alpha, mu, lambda
+   and dimension. The buffers only grow, so once a run is under way
+   this allocates nothing.
+   The capacity of the run covers the archive and the new individuals
+   and migrants of a generation, i.e. max_archive + max(alpha, lambda)
+   for a bounded archive without islands. If the archive outgrows it, it at least doubles and the
+   pool of individuals and everything else that grows with the archive
+   is enlarged at once, at the start of the generation. */
+int workspace_reserve()
+{
+     double *tmp;
+     int needed, capacity;
+
+     needed = get_size() + (alpha > lambda ? alpha : lambda)
+          + island_migrants();
+     if (needed > work_capacity)
+     {
+          capacity = 2 * work_capacity > needed ? 2 * work_capacity : needed;
+          if (work_capacity == 0) /* sized for the archive to come */
+               capacity = needed + (max_archive > 0 ? max_archive
+                                    : expected_archive);
+          if (reserve_individuals(capacity) != 0
+              || grow_ints(&work_candidates, &work_candidates_size,
+                           capacity) != 0
+              || grow_ints(&work_members, &work_members_size, capacity) != 0
+              || reserve_tombstones(capacity) != 0
+              || backend->reserve(capacity) != 0
+              || truncation_reserve(capacity) != 0
+              || hv_reserve(capacity) != 0
+              || duplicate_reserve(capacity) != 0
+              || search_reserve(capacity) != 0
+              || history_reserve(capacity) != 0
+              || export_reserve(capacity) != 0
+              || pipeline_reserve(capacity) != 0
+              || island_reserve(capacity) != 0)
+               return (1);
+          work_capacity = capacity;
+          alloc_grown();
+     }
+
+     if (grow_ints(&work_identities, &work_identities_size,
+                   alpha > lambda ? alpha : lambda) != 0
+         || grow_ints(&work_parents, &work_parents_size,
+                      mu > async_parents ? mu : async_parents) != 0
+         || grow_ints(&work_alive, &work_alive_size, variator_count) != 0
+         || grow_ints(&work_hits, &work_hits_size, variator_count) != 0
+         || query_reserve() != 0)
+          return (1);
+     if (work_values_size < dimension)
+     {
+          tmp = (double *) realloc(work_values, dimension * sizeof(double));
+          if (tmp == NULL)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "selector out of memory");
+               return (1);
+          }
+          work_values = tmp;
+          work_values_size = dimension;
+     }
+     return (0);
+}
+
+
+/* Makes the pool hold 'count' individuals, the new ones become spares
+   with the handles up to count - 1. Returns 0 if successful and 1 if
+   out of memory. */
+int reserve_individuals(int count)
+{
+     individual **tmp;
+     individual *ind;
+
+     if (count > spare_capacity)
+     {
+          tmp = (individual **) realloc(spare_individuals,
+                                        count * sizeof(individual *));
+          if (tmp == NULL)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "selector out of memory");
+               return (1);
+          }
+          spare_individuals = tmp;
+          spare_capacity = count;
+     }
+     while (handle_count < count)
+     {
+          ind = (individual *) malloc(sizeof(individual));
+          if (ind == NULL)
+          {
+               log_to_file(log_file, __FILE__, __LINE__,
+                           "selector out of memory");
+               return (1);
+          }
+          ind->objective_value = NULL;
+          /* file-backed values live in the file, those of femo_mpi on
+             the ranks */
+          if (!store_enabled && !mpi_active)
+          {
+               ind->objective_value =
+                    (objective_t *) malloc(sizeof(objective_t) * dimension);
+               if (ind->objective_value == NULL)
+               {
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "selector out of memory");
+                    free(ind);
+                    return (1);
+               }
+          }
+          ind->handle = handle_count++;
+          spare_individuals[spare_count++] = ind;
+     }
+     return (0);
+}
+
+
+/* Frees the workspace and the spare individuals. */
+void workspace_free()
+{
+     while (spare_count > 0)
+     {
+          spare_count--;
+          free(spare_individuals[spare_count]->objective_value);
+          free(spare_individuals[spare_count]);
+     }
+     free(spare_individuals);
+     free(work_values);
+     free(work_identities);
+     free(work_parents);
+     free(work_candidates);
+     free(work_members);
+     free(work_alive);
+     free(work_hits);
+     spare_individuals = NULL;
+     work_values = NULL;
+     work_identities = NULL;
+     work_parents = NULL;
+     work_candidates = NULL;
+     work_members = NULL;
+     work_alive = NULL;
+     work_hits = NULL;
+     spare_capacity = 0;
+     work_capacity = 0;
+     handle_count = 0;
+     work_values_size = 0;
+     work_identities_size = 0;
+     work_parents_size = 0;
+     work_candidates_size = 0;
+     work_members_size = 0;
+     work_alive_size = 0;
+     work_hits_size = 0;
+}
+
+
+/* Resets the counters of the stopping criteria at the start of a
+   run. */
+void start_run()
+{
+     generation = 0;
+     evaluations = 0;
+     stagnant_generations = 0;
+     start_time = time(NULL);
+}
+
+
+/* Does the selection of one generation after 'size' new individuals
+   have been added: select_ind(), then the bookkeeping that follows
+   every selection. */
+int run_selection(int size, int *new_identity, int *sel_identities)
+{
+     if (record_batch(size, new_identity) != 0
+         || select_ind(size, new_identity, sel_identities, dimension) != 0)
+     {
+          log_to_file(log_file, __FILE__, __LINE__, "selection failed");
+          return (1);
+     }
+     track_progress(size);
+     write_stats();
+     compact_population();
+     if (export_archive(0) != 0 || history_commit() != 0)
+          return (1);
+     return (record_result(orphaned ? 0 : mu, sel_identities));
+}
+
+
+/* Implements FEMO. Takes size individual from variation, updates global
+   population and selects mu new individual for variation. */
+int select_ind(int size, int *new_identity, int *sel_identities,
+               int dimension)
+{
+     if (update_archive(size, new_identity, dimension) != 0)
+          return (1);
+     if (island_migrate() != 0)
+          return (1);
+     orphaned = get_next_own(-1) == -1;
+     if (orphaned)
+          return (0);
+     return (choose_parents(mu, sel_identities));
+}
+
+
+/* Rejects the new individuals that would remove the last archive
+   member of another variator (alone or together with the new ones
+   kept before them), as spare_own_members() in femo_island.c does for
+   migrants, so the offspring of one variator never leave another
+   without parents. Returns 0 if successful and 1 otherwise. */
+static int spare_other_variators(int size, int *new_identity)
+{
+     int i, j, n, channel, orphans;
+
+     if (variator_count < 2)
+          return (0);
+     for (i = 0; i < variator_count; i++)
+          work_alive[i] = 0;
+     n = 0;
+     for (i = get_first(); i != -1; i = get_next(i))
+     {
+          channel = get_owner(i);
+          if (channel < variator_count && channel != current_channel)
+          {
+               work_members[n++] = i;
+               work_alive[channel]++;
+          }
+     }
+
+     for (j = 0; j < size && n > 0; j++)
+     {
+          if (get_individual(new_identity[j]) == NULL)
+               continue; /* rejected as equal */
+          for (i = 0; i < variator_count; i++)
+               work_hits[i] = 0;
+          for (i = 0; i < n; i++)
+          {
+               if (work_members[i] != -1
+                   && dominates(new_identity[j], work_members[i], dimension))
+                    work_hits[get_owner(work_members[i])]++;
+          }
+          orphans = 0;
+          for (i = 0; i < variator_count; i++)
+               orphans |= work_alive[i] > 0 && work_hits[i] == work_alive[i];
+          if (orphans)
+          {
+               if (femo_remove(new_identity[j]) != 0)
+               {
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "removing individual failed");
+                    return (1);
+               }
+               continue;
+          }
+
+          /* kept: the members it dominates will be removed */
+          for (i = 0; i < n; i++)
+          {
+               if (work_members[i] != -1
+                   && dominates(new_identity[j], work_members[i], dimension))
+               {
+                    work_alive[get_owner(work_members[i])]--;
+                    work_members[i] = -1;
+               }
+          }
+     }
+     return (0);
+}
+
+
+/* Inserts the size new individuals into the archive and removes the
+   individuals that are dominated (or rejected) from the global
+   population. Returns 0 if successful and 1 otherwise. */
+int update_archive(int size, int *new_identity, int dimension)
+{
+     int i;
+     int equal; /* individual with the same objective vector, or -1 */
+     int result;
+     int bulk; /* 1 if the archive consists of the new individuals */
+     double span_begin;
+
+     assert(dimension >= 0);
+     bulk = get_size() == size && !epsilon_enabled && duplicates_enabled;
+
+     /* reject new individuals that are equal in all objective values
+        to another one (of equal new individuals the first is kept);
+        with the 'mpi' backend the duplicate set is off and the ranks
+        reject them */
+     span_begin = trace_begin();
+     for(i = 0; i < size; i++)
+     {
+          store_bind(new_identity[i]);
+          if (duplicate_insert(new_identity[i], &equal) != 0)
+               return (1);
+          if (equal != -1)
+          {
+               result = femo_remove(new_identity[i]);
+               if (result != 0)
+               {
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "removing individual failed");
+                    return (1);
+               }
+          }
+     }
+     trace_end("reject_equal", "select", span_begin);
+
+     if (spare_other_variators(size, new_identity) != 0)
+          return (1);
+
+     /* members dominated by a new individual and new individuals
+        dominated by a member leave the archive; the initial population
+        is filtered in one go if possible */
+     result = bulk ? bulk_filter(size, new_identity) : 2;
+     if (result == 1)
+          return (1);
+     for(i = 0; i < size && result == 0; i++)
+     {
+          if (get_individual(new_identity[i]) != NULL
+              && backend->adopt(new_identity[i]) != 0)
+               return (1);
+     }
+     if (result == 2 && backend->insert_batch(size, new_identity) != 0)
+          return (1);
+
+     /* the surviving new individuals are now archive members */
+     for(i = 0; i < size; i++)
+     {
+          if (get_individual(new_identity[i]) != NULL)
+          {
+               if (hv_insert(new_identity[i]) != 0
+                   || truncation_insert(new_identity[i]) != 0
+                   || search_insert(new_identity[i]) != 0
+                   || history_insert(new_identity[i]) != 0)
+                    return (1);
+          }
+     }
+
+     /* bounded archive: evict the members with the smallest
+        contribution */
+     if (max_archive > 0)
+     {
+          while (get_size() > max_archive)
+          {
+               result = femo_remove(truncation_worst());
+               if (result != 0)
+               {
+                    log_to_file(log_file, __FILE__, __LINE__,
+                                "removing individual failed");
+                    return (1);
+               }
+          }
+     }
+
+     accepted = 0;
+     for(i = 0; i < size; i++)
+     {
+          if (get_individual(new_identity[i]) != NULL)
+               accepted++;
+     }
+     return (0);
+}
+
+
+/* Chooses count parents with femo_choose() and increases their
+   counters. Returns 0 if successful and 1 otherwise. */
+int choose_parents(int count, int *sel_identities)
+{
+     int i, pos;
+     double span_begin;
+
+     /* uniformly choose mu individual as described in femo */
+     span_begin = trace_begin();
+     for(i = 0; i < count; i++)
+     {
+          pos = backend->choose();
+          if (pos == -1) /* Choosing failed. */
+               return (1);
+          increase_counter(pos);
+          sel_identities[i] = pos;
+     }
+     trace_end("choose_parents", "select", span_begin);
+     return (0);
+}
+
+
+/* Asynchronous mode: inserts the results of every worker that has
+   finished into the archive, one worker after the other, and hands out
+   new parents to it right away. Each worker counts as one generation.
+   The 'arc' file is rewritten whenever the variator has read the
+   previous one. Returns 0 once a stopping criterion applied and the
+   final archive has been written, 2 if the optimization goes on and 1
+   if an error happened. */
+int select_async()
+{
+     int k, count, result;
+     int *offspring; /* identities read by async_read() */
+     int *parent_identities;
+
+     if (workspace_reserve() != 0)
+          return (1);
+     parent_identities = work_parents;
+
+     for (k = 0; k < async_slots && !async_finished; k++)
+     {
+          if (async_read(k, &offspring, &count) != 0)
+               return (1);
+          if (count == 0) /* still busy */
+               continue;
+
+          generation++;
+          result = update_archive(count, offspring, dimension);
+          if (result == 0)
+               result = island_migrate();
+          if (result != 0)
+          {
+               log_to_file(log_file, __FILE__, __LINE__, "selection failed");
+               return (1);
+          }
+          track_progress(count);
+          write_stats();
+          compact_population();
+          arc_outdated = 1;
+
+          if (is_finished())
+               async_finished = 1; /* the remaining workers are idle */
+          else if (choose_parents(async_parents, parent_identities) != 0
+                   || async_write(k, parent_identities, async_parents) != 0)
+               return (1);
+          if (export_archive(0) != 0 || history_commit() != 0)
+               return (1);
+     }
+
+     if (arc_outdated)
+     {
+          result = async_write_arc();
+          if (result == 1)
+          {
+               log_to_file(log_file, __FILE__, __LINE__, "failed write_arc()");
+               return (1);
+          }
+          arc_outdated = result == 2;
+     }
+     return (async_finished && !arc_outdated ? 0 : 2);
+}
+
+
+/* Removes an individual from the global population and from the
+   hypervolume, truncation, backend and duplicate bookkeeping. The
+   population is compacted once 'tombstone_limit' removed individuals
+   have piled up. Returns 0 if successful and 1 otherwise. */
+int femo_remove(int id)
+{
+     if (history_remove(id) != 0 || hv_remove(id) != 0 || truncation_remove(id) != 0
+         || backend->remove(id) != 0 || duplicate_remove(id) != 0
+         || search_remove(id) != 0)
+          return (1);
+     if (remove_individual(id) != 0)
+          return (1);
+     if (tombstone_limit > 0 && get_tombstones() >= tombstone_limit)
+          return (compact_population());
+     return (0);
+}
+
+
+/* Restores the archive from the archive file after a restart in
+   state 3 and rebuilds all bookkeeping of the archive. Returns 0 if
+   successful and 1 otherwise. */
+int femo_restore()
+{
+     int current_id, equal;
+
+     if (store_open(archive_file, 1) != 0)
+          return (1);
+     generation = store_completed() < 0 ? 0 : store_completed();
+     start_time = time(NULL);
+
+     current_id = get_first();
+     while (current_id != -1)
+     {
+          if (duplicate_insert(current_id, &equal) != 0
+              || hv_insert(current_id) != 0
+              || truncation_insert(current_id) != 0
+              || search_insert(current_id) != 0
+              || backend->adopt(current_id) != 0)
+               return (1);
+          current_id = get_next(current_id);
+     }
+     return (0);
+}
+
+
+/* Updates the counters used by is_finished() after a selection of
+   'size' new individuals. */
+int track_progress(int size)
+{
+     double hv;
+     int progress;
+
+     evaluations += size;
+
+     progress = accepted > 0;
+     if (hv_enabled)
+     {
+          hv = hv_value();
+          if (generation > 0 && stagnation_hv_change > 0
+              && fabs(hv - last_hv) <= stagnation_hv_change * fabs(last_hv))
+               progress = 0;
+          last_hv = hv;
+     }
+
+     if (progress || generation == 0)
+          stagnant_generations = 0;
+     else
+          stagnant_generations++;
+     return (0);
+}
+
+
+/* Appends one line to the stats file (if there is one). */
+int write_stats()
+{
+     double span_begin;
+
+     if (stats_fp == NULL)
+          return (0);
+
+     span_begin = trace_begin();
+     if (hv_enabled)
+          fprintf(stats_fp, "%d %d %.12e\n", generation, get_size(),
+                  hv_value());
+     else
+          fprintf(stats_fp, "%d %d -\n", generation, get_size());
+     fflush(stats_fp);
+     trace_end("write_stats", "io", span_begin);
+     return (0);
+}
+
+
+/* Determines if one individual dominates another.
+   Minimizing fitness values. The loop has no early exit, so the
+   compiler can vectorize it over the stored objective values. */
+int dominates(int ind_a, int ind_b, int dim)
+{
+     int i;
+     int a_is_worse = 0;
+     int differs = 0;
+     objective_t *obj_a, *obj_b;
+
+     obj_a = get_individual(ind_a)->objective_value;
+     obj_b = get_individual(ind_b)->objective_value;
+     for (i = 0; i < dim; i++)
+     {
+          a_is_worse |= obj_a[i] > obj_b[i];
+          differs |= obj_a[i] != obj_b[i];
+     }
+     
+     return (differs && !a_is_worse);
+}
+
+
+/* Determines if two individuals are equal in all objective values.*/
+int is_equal(int ind_a, int ind_b, int dim)
+{
+     int i;
+     int differs = 0;
+     objective_t *obj_a, *obj_b;
+
+     obj_a = get_individual(ind_a)->objective_value;
+     obj_b = get_individual(ind_b)->objective_value;
+     for (i = 0; i < dim; i++)
+          differs |= obj_a[i] != obj_b[i];
+     return (!differs);
+}
+
 
 /* Generate a random integer. */
 int irand(int range)
@@ -558,21 +1728,19 @@ int femo_choose()
      int *ids_to_choose;
      int size, min, current_id, pick_id, return_id;
      
-     ids_to_choose = (int *) malloc(get_size() * sizeof(int));
-     if (ids_to_choose == NULL)
-     {
-          log_to_file(log_file, __FILE__, __LINE__, "selector out of memory");
+     /**** Changed for FEMO: the candidates are kept in the workspace */
+     if (grow_ints(&work_candidates, &work_candidates_size, get_size()) != 0)
           return (-1);
-     }  
+     ids_to_choose = work_candidates;
      
-     current_id = get_first();
+     current_id = get_next_own(-1);
      if(current_id == -1)
           return(-1);
      
      min = get_counter(current_id);
      size = 1;
      ids_to_choose[0] = current_id;
-     current_id = get_next(current_id);
+     current_id = get_next_own(current_id);
      while(current_id != -1)
      {
           if(min > get_counter(current_id))
@@ -586,19 +1754,27 @@ int femo_choose()
                size++;
                ids_to_choose[size - 1] = current_id;
           }
-          current_id = get_next(current_id);
+          current_id = get_next_own(current_id);
      }
      
      pick_id = irand(size);
      
      return_id = ids_to_choose[pick_id];
-
-     free(ids_to_choose);
      
      return (return_id);
 }
 
 
+int get_next_own(int id)
+{
+     id = get_next(id);
+     while (channel_count > 1 && id != -1
+            && get_owner(id) != current_channel)
+          id = get_next(id);
+     return (id);
+}
+
+
 int get_counter(int id)
 {
      individual* temp;
@@ -616,6 +1792,7 @@ int increase_counter(int id)
      if(temp == NULL)
           return(1);
      temp->counter++;
+     store_counter(temp->slot, temp->counter);
      return(0);
 }
 
@@ -627,6 +1804,7 @@ int decrease_counter(int id)
      if(temp == NULL)
           return(1);
      temp->counter--;
+     store_counter(temp->slot, temp->counter);
      return(0);
 }
 
@@ -640,4 +1818,14 @@ double get_objective_value(int id, int index)
      return(temp->objective_value[index]);  
 }
 
+
+int get_handle(int id)
+{
+     individual *temp;
+     temp = get_individual(id);
+     if(temp == NULL)
+          return(-1);
+     return(temp->handle);
+}
+
 /**********| addition for FEMO end |*******/
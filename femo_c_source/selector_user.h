@@ -45,13 +45,41 @@ extern char *log_file; /* file to log to */
 
 extern char paramfile[]; /* file with local parameters */
 
+/**********| added for FEMO |**************/
+
+extern int generation; /* number of selections since state 1 */
+
+extern int accepted; /* new individuals accepted by the last selection */
+
+extern int orphaned; /* 1 if no parents could be selected for the
+                        current variator */
+
+/**********| addition for FEMO end |*******/
+
+/**********| added for FEMO |**************/
+
+/* Objective values are stored as 'double', or as 'float' if
+   FEMO_FLOAT_OBJECTIVES is defined ('make FLOAT=1'). In the latter
+   case each value is rounded to the nearest float (ties to even,
+   values beyond the float range become infinite) when the individual
+   is added, and all comparisons use the rounded values. */
+#ifdef FEMO_FLOAT_OBJECTIVES
+typedef float objective_t;
+#else
+typedef double objective_t;
+#endif
+
+/**********| addition for FEMO end |*******/
+
 /*-----------------------------------------------------------------------*/
 
 struct individual_t
 {
      /**********| added for FEMO |**************/
-     double *objective_value;
+     objective_t *objective_value;
      int counter;
+     int slot; /* record in the archive file, -1 if not file-backed */
+     int handle; /* number in the pool of individuals, kept for life */
      /**********| addition for FEMO end |*******/
 };
 
@@ -127,6 +155,26 @@ int state3();
          return value == 0 if successful,
                       == 1 if unspecified errors happened,
                       == 2 if file reading failed.
+
+   remark: In FEMO's asynchronous mode state 3 lasts for the whole run:
+           return value == 0 once the optimization is finished,
+                        == 2 while it goes on.
+*/
+
+
+int restart();
+/* Do what needs to be done if the selector is started in state 3.
+
+   pre: The common parameters have been read. The selector has been
+        restarted (e.g. after a crash) while the variator waits for a
+        selection.
+
+   post: local parameters read
+         optionally restore the archive
+         return value == 0 if the last selection had been completed,
+                      == 1 if unspecified errors happened,
+                      == 2 if the last selection may have been
+                           interrupted and has to be done again.
 */
 
 
@@ -188,8 +236,8 @@ int is_finished();
    post: return value == 1 if optimization should stop
          return value == 0 if optimization should continue
 
-   remark: Normally the variator decides when to terminate. So
-           just return 0.
+   remark: Normally the variator decides when to terminate. FEMO
+           checks the stopping criteria from the parameter file.
 */
 
 /**********| added for FEMO |**************/
@@ -197,11 +245,73 @@ int is_finished();
 /* read local parameters from file */
 int read_local_parameters();
 
+/* read local parameters from an open file, which is closed */
+int read_parameters(FILE *fp);
+
+/* buffers of the run, reused every generation (see workspace_reserve()) */
+
+extern double *work_values; /* objective values of one individual */
+
+extern int *work_identities; /* new individuals, max(alpha, lambda) */
+
+extern int *work_parents; /* parents, max(mu, async_parents) */
+
+extern int work_capacity; /* individuals the run is sized for, the
+                             handles are below it */
+
+/* make 'buffer' hold 'count' ints, growing it at least twofold */
+int grow_ints(int **buffer, int *size, int count);
+
+/* make the buffers of the run large enough for alpha, mu, lambda and
+   dim and the capacity large enough for the archive and a generation
+   of new individuals; nothing is allocated unless one of them grew */
+int workspace_reserve();
+
+/* make the pool hold 'count' individuals (handles 0 .. count - 1) */
+int reserve_individuals(int count);
+
+/* free the buffers of the run and the spare individuals */
+void workspace_free();
+
+/* reset the counters of the stopping criteria (start of a run) */
+void start_run();
+
+/* select_ind() followed by the bookkeeping of a generation (progress,
+   statistics, compaction), used by state1(), state3() and the daemon */
+int run_selection(int size, int *new_identity, int *sel_identities);
+
 /* select mu individuals out of new_identity (of size size)
    and return their ids */ 
 int select_ind(int size, int *new_identity, int *sel_identities,
                 int dimension);
 
+/* insert size new individuals into the archive (first part of
+   select_ind) */
+int update_archive(int size, int *new_identity, int dimension);
+
+/* choose count parents and increase their counters (second part of
+   select_ind) */
+int choose_parents(int count, int *sel_identities);
+
+/* process the results of the workers in the asynchronous mode,
+   returns 0 when finished and 2 while going on */
+int select_async();
+
+/* Removes an individual from the global population and from all
+   bookkeeping of the archive. */
+int femo_remove(int id);
+
+/* Restores the archive from the archive file after a restart. */
+int femo_restore();
+
+/* Updates the counters for the stopping criteria after a selection
+   of 'size' new individuals. */
+int track_progress(int size);
+
+/* Appends one line with generation, archive size and hypervolume to
+   the stats file. */
+int write_stats();
+
 /* Determines if one individual dominates another.
    Minimizing fitness values. */
 int dominates(int ind_a, int ind_b, int dim);
@@ -214,6 +324,10 @@ int irand(int range);
 /* choose individual with lowest counter uniformly */
 int femo_choose();
 
+/* next individual after id that belongs to the current variator, -1
+   if there is none (get_next() with a single variator) */
+int get_next_own(int id);
+
 int get_counter(int id);
 
 int increase_counter(int id);
@@ -222,6 +336,10 @@ int decrease_counter(int id);
 
 double get_objective_value(int id, int index);
 
+/* handle of an individual (see workspace_reserve()), -1 if there is
+   no individual 'id' */
+int get_handle(int id);
+
 /**********| addition for FEMO end |*******/
 
 